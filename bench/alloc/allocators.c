@@ -0,0 +1,262 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocators.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <descent/alloc/stackalloc.h>
+#include <descent/alloc/sysalloc.h>
+#include <descent/alloc/varray.h>
+#include <descent/rcode.h>
+
+#if defined(DESCENT_BENCH_SCRIPT)
+#include <descent/script/alloc.h>
+#endif
+
+// Large enough for the largest block of any pattern
+#ifndef DESCENT_BENCH_RESERVE
+#define DESCENT_BENCH_RESERVE 0x10000000ULL
+#endif
+
+// C library
+
+static rcode malloc_init(void **state) {
+	*state = NULL;
+	return 0;
+}
+
+static rcode malloc_release(void *state) {
+	(void) state;
+	return 0;
+}
+
+static void *malloc_alloc(void *state, size_t size) {
+	(void) state;
+	return malloc(size);
+}
+
+static void malloc_free(void *state, void *block, size_t size) {
+	(void) state;
+	(void) size;
+	free(block);
+}
+
+// Sysalloc, one mapping per block
+
+static void *sysalloc_alloc(void *state, size_t size) {
+	(void) state;
+	Sysalloc s = {.size = size};
+	return sysalloc(&s, SYSALLOC_ACCESS_READ_WRITE) ? NULL : s.base;
+}
+
+static void sysalloc_free(void *state, void *block, size_t size) {
+	(void) state;
+	Sysalloc s = {.base = block, .size = size};
+	sysfree(&s);
+}
+
+// Sysalloc, committing and decommitting a fixed reservation
+
+static rcode reserve_init(void **state) {
+	Sysalloc *s = malloc(sizeof(Sysalloc));
+	if (!s) return DESCENT_ERROR_MEMORY;
+
+	s->base = NULL;
+	s->size = DESCENT_BENCH_RESERVE;
+
+	rcode result = sysalloc_reserve(s);
+	if (result) {
+		free(s);
+		return result;
+	}
+
+	*state = s;
+	return 0;
+}
+
+static rcode reserve_release(void *state) {
+	rcode result = sysfree(state);
+	free(state);
+	return result;
+}
+
+static void *reserve_alloc(void *state, size_t size) {
+	Sysalloc *s = state;
+	size_t granularity = sysalloc_granularity();
+	size = (size + granularity - 1) & ~(granularity - 1);
+	return sysalloc_commit(s, 0, size, SYSALLOC_ACCESS_READ_WRITE) ? NULL : s->base;
+}
+
+static void reserve_free(void *state, void *block, size_t size) {
+	(void) block;
+	size_t granularity = sysalloc_granularity();
+	size = (size + granularity - 1) & ~(granularity - 1);
+	sysalloc_decommit(state, 0, size);
+}
+
+// Virtual array, growing and shrinking a byte array
+
+static rcode varray_bench_init(void **state) {
+	VArray *v = malloc(sizeof(VArray));
+	if (!v) return DESCENT_ERROR_MEMORY;
+
+	rcode result = varray_init(v, 1, DESCENT_BENCH_RESERVE);
+	if (result) {
+		free(v);
+		return result;
+	}
+
+	*state = v;
+	return 0;
+}
+
+static rcode varray_bench_release(void *state) {
+	rcode result = varray_release(state);
+	free(state);
+	return result;
+}
+
+static void *varray_bench_alloc(void *state, size_t size) {
+	return varray_resize(state, size) ? NULL : varray_data(state);
+}
+
+static void varray_bench_free(void *state, void *block, size_t size) {
+	(void) block;
+	(void) size;
+	varray_resize(state, 0);
+	varray_shrink(state);
+}
+
+// Stack allocator, using the calling thread's instance
+
+static rcode stackalloc_bench_init(void **state) {
+	return stackalloc_self((Stackalloc **) state);
+}
+
+static rcode stackalloc_bench_release(void *state) {
+	return stackalloc_trim(state);
+}
+
+static void *stackalloc_bench_alloc(void *state, size_t size) {
+	void *block = NULL;
+	return stackalloc(state, size, 16, &block) ? NULL : block;
+}
+
+static void stackalloc_bench_free(void *state, void *block, size_t size) {
+	(void) state;
+	(void) block;
+	(void) size;
+}
+
+static size_t stackalloc_bench_mark(void *state) {
+	return stackalloc_push(state);
+}
+
+static void stackalloc_bench_reset(void *state, size_t mark) {
+	stackalloc_pop(state, mark);
+}
+
+#if defined(DESCENT_BENCH_SCRIPT)
+
+// Script allocator, one capped instance per thread
+
+static rcode script_init(void **state) {
+	ScriptAllocator *a = malloc(sizeof(ScriptAllocator));
+	if (!a) return DESCENT_ERROR_MEMORY;
+
+	rcode result = script_allocator_init(a, DESCENT_BENCH_RESERVE);
+	if (result) {
+		free(a);
+		return result;
+	}
+
+	*state = a;
+	return 0;
+}
+
+static rcode script_release(void *state) {
+	rcode result = script_allocator_release(state);
+	free(state);
+	return result;
+}
+
+static void *script_alloc(void *state, size_t size) {
+	return script_allocator_lua(state, NULL, 0, size);
+}
+
+static void script_free(void *state, void *block, size_t size) {
+	script_allocator_lua(state, block, size, 0);
+}
+
+#endif
+
+const BenchAllocator bench_allocators[] = {
+	{
+		.name = "malloc",
+		.flags = BENCH_ALLOC_SHARED,
+		.init = malloc_init,
+		.release = malloc_release,
+		.alloc = malloc_alloc,
+		.free = malloc_free,
+	},
+	{
+		.name = "sysalloc",
+		.flags = BENCH_ALLOC_SHARED,
+		.init = malloc_init,
+		.release = malloc_release,
+		.alloc = sysalloc_alloc,
+		.free = sysalloc_free,
+	},
+	{
+		.name = "sysalloc-commit",
+		.flags = BENCH_ALLOC_SINGLE,
+		.init = reserve_init,
+		.release = reserve_release,
+		.alloc = reserve_alloc,
+		.free = reserve_free,
+	},
+	{
+		.name = "varray",
+		.flags = BENCH_ALLOC_SINGLE,
+		.init = varray_bench_init,
+		.release = varray_bench_release,
+		.alloc = varray_bench_alloc,
+		.free = varray_bench_free,
+	},
+	{
+		.name = "stackalloc",
+		.flags = BENCH_ALLOC_LIFO,
+		.init = stackalloc_bench_init,
+		.release = stackalloc_bench_release,
+		.alloc = stackalloc_bench_alloc,
+		.free = stackalloc_bench_free,
+		.mark = stackalloc_bench_mark,
+		.reset = stackalloc_bench_reset,
+	},
+#if defined(DESCENT_BENCH_SCRIPT)
+	{
+		.name = "script",
+		.flags = 0,
+		.init = script_init,
+		.release = script_release,
+		.alloc = script_alloc,
+		.free = script_free,
+	},
+#endif
+};
+
+const unsigned int bench_allocator_count = sizeof(bench_allocators) / sizeof(bench_allocators[0]);
@@ -0,0 +1,45 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_BENCH_ALLOC_ALLOCATORS_H
+#define DESCENT_BENCH_ALLOC_ALLOCATORS_H
+
+#include <stddef.h>
+
+#include <descent/rcode.h>
+
+enum {
+	BENCH_ALLOC_SHARED = 1 << 0, // Blocks may be freed by a different thread than allocated them
+	BENCH_ALLOC_LIFO   = 1 << 1, // Blocks are only freed by resetting to a mark
+	BENCH_ALLOC_SINGLE = 1 << 2, // Only one block may be live at a time
+};
+
+// Allocator states are per-thread, so that allocators which are not
+// thread-safe can be measured under the same harness
+typedef struct {
+	const char *name;
+	int         flags;
+	rcode     (*init)(void **state);
+	rcode     (*release)(void *state);
+	void     *(*alloc)(void *state, size_t size);
+	void      (*free)(void *state, void *block, size_t size);
+	size_t    (*mark)(void *state);
+	void      (*reset)(void *state, size_t mark);
+} BenchAllocator;
+
+extern const BenchAllocator bench_allocators[];
+extern const unsigned int bench_allocator_count;
+
+#endif
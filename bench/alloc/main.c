@@ -0,0 +1,566 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/utilities/platform.h>
+#if defined(DESCENT_PLATFORM_LINUX)
+#define _GNU_SOURCE
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <descent/alloc/ring.h>
+#include <descent/cli.h>
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/thread.h>
+#include <descent/time.h>
+
+#include "allocators.h"
+
+// Operations per thread at scale 1
+#define BENCH_OPERATIONS (1u << 20)
+
+// One operation in every BENCH_SAMPLE_INTERVAL is timed
+#define BENCH_SAMPLE_INTERVAL 64u
+#define BENCH_SAMPLE_MAX (BENCH_OPERATIONS / BENCH_SAMPLE_INTERVAL)
+
+#define BENCH_SMALL_MIN 16u
+#define BENCH_SMALL_MAX 512u
+#define BENCH_CHURN_WINDOW 256u
+#define BENCH_FRAME_OBJECTS 1024u
+#define BENCH_LARGE_STEP 0x10000u
+#define BENCH_LARGE_STEPS 128u
+#define BENCH_LARGE_DIVISOR 1024u
+#define BENCH_PAGE 0x1000u
+#define BENCH_RING_SIZE 0x10000u
+
+#define BENCH_GO_RUN   1u
+#define BENCH_GO_ABORT 2u
+
+typedef struct {
+	void  *block;
+	size_t size;
+} BenchBlock;
+
+typedef struct {
+	uint64_t  elapsed;
+	uint64_t  operations;
+	uint32_t *samples;
+	size_t    sample_count;
+	uint64_t  rng;
+	rcode     result;
+} BenchThread;
+
+struct BenchPattern;
+
+typedef struct {
+	const BenchAllocator      *allocator;
+	const struct BenchPattern *pattern;
+	unsigned int               threads;
+	uint64_t                   operations;
+	atomic_32                  next;
+	atomic_32                  ready;
+	atomic_32                  go;
+	BenchThread               *thread;
+	RingBuffer                *rings;
+} BenchRun;
+
+typedef struct BenchPattern {
+	const char *name;
+	int       (*supports)(const BenchAllocator *a, unsigned int threads);
+	rcode     (*run)(BenchRun *run, unsigned int index, void *state);
+} BenchPattern;
+
+typedef struct {
+	unsigned int threads;
+	unsigned int scale;
+	const char  *pattern;
+	const char  *allocator;
+} Settings;
+
+static inline uint64_t bench_random(BenchThread *t) {
+	// xorshift64
+	uint64_t x = t->rng;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	t->rng = x;
+	return x;
+}
+
+static inline size_t bench_small_size(BenchThread *t) {
+	return BENCH_SMALL_MIN + (size_t) (bench_random(t) % (BENCH_SMALL_MAX - BENCH_SMALL_MIN + 1));
+}
+
+static inline void bench_sample(BenchThread *t, uint64_t start) {
+	if (t->sample_count < BENCH_SAMPLE_MAX) {
+		uint64_t elapsed = time_nanoseconds() - start;
+		t->samples[t->sample_count++] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t) elapsed;
+	}
+}
+
+// Many small short-lived objects, freed in random order
+
+static int churn_supports(const BenchAllocator *a, unsigned int threads) {
+	(void) threads;
+	return !(a->flags & (BENCH_ALLOC_LIFO | BENCH_ALLOC_SINGLE));
+}
+
+static rcode churn_run(BenchRun *run, unsigned int index, void *state) {
+	const BenchAllocator *a = run->allocator;
+	BenchThread *t = &run->thread[index];
+	BenchBlock window[BENCH_CHURN_WINDOW] = {0};
+
+	for (uint64_t i = 0; i < run->operations; ++i) {
+		BenchBlock *b = &window[bench_random(t) % BENCH_CHURN_WINDOW];
+		size_t size = bench_small_size(t);
+
+		uint64_t start = (i % BENCH_SAMPLE_INTERVAL) ? 0 : time_nanoseconds();
+
+		if (b->block) a->free(state, b->block, b->size);
+		b->block = a->alloc(state, size);
+		b->size = size;
+
+		if (start) bench_sample(t, start);
+		if (!b->block) return DESCENT_ERROR_MEMORY;
+
+		*(volatile char *) b->block = (char) i;
+	}
+
+	for (unsigned int i = 0; i < BENCH_CHURN_WINDOW; ++i) {
+		if (window[i].block) a->free(state, window[i].block, window[i].size);
+	}
+
+	t->operations = run->operations;
+	return 0;
+}
+
+// Bursts of allocations that are all freed at the end of a frame
+
+static int frame_supports(const BenchAllocator *a, unsigned int threads) {
+	(void) threads;
+	return !(a->flags & BENCH_ALLOC_SINGLE);
+}
+
+static rcode frame_run(BenchRun *run, unsigned int index, void *state) {
+	const BenchAllocator *a = run->allocator;
+	BenchThread *t = &run->thread[index];
+	BenchBlock frame[BENCH_FRAME_OBJECTS];
+
+	uint64_t frames = run->operations / BENCH_FRAME_OBJECTS;
+
+	for (uint64_t f = 0; f < frames; ++f) {
+		size_t mark = a->mark ? a->mark(state) : 0;
+
+		for (unsigned int i = 0; i < BENCH_FRAME_OBJECTS; ++i) {
+			size_t size = bench_small_size(t);
+
+			uint64_t start = (i % BENCH_SAMPLE_INTERVAL) ? 0 : time_nanoseconds();
+			frame[i].block = a->alloc(state, size);
+			frame[i].size = size;
+			if (start) bench_sample(t, start);
+
+			if (!frame[i].block) return DESCENT_ERROR_MEMORY;
+			*(volatile char *) frame[i].block = (char) i;
+		}
+
+		if (a->reset) a->reset(state, mark);
+		else for (unsigned int i = BENCH_FRAME_OBJECTS; i--;) a->free(state, frame[i].block, frame[i].size);
+	}
+
+	t->operations = frames * BENCH_FRAME_OBJECTS;
+	return 0;
+}
+
+// Large blocks whose pages are all touched, then released
+
+static int large_supports(const BenchAllocator *a, unsigned int threads) {
+	(void) a;
+	(void) threads;
+	return 1;
+}
+
+static rcode large_run(BenchRun *run, unsigned int index, void *state) {
+	const BenchAllocator *a = run->allocator;
+	BenchThread *t = &run->thread[index];
+
+	uint64_t operations = run->operations / BENCH_LARGE_DIVISOR;
+	if (!operations) operations = 1;
+
+	for (uint64_t i = 0; i < operations; ++i) {
+		size_t size = (1 + (size_t) (bench_random(t) % BENCH_LARGE_STEPS)) * BENCH_LARGE_STEP;
+		size_t mark = a->mark ? a->mark(state) : 0;
+
+		// Every large operation is timed, since there are few of them
+		uint64_t start = time_nanoseconds();
+
+		char *block = a->alloc(state, size);
+		if (!block) return DESCENT_ERROR_MEMORY;
+
+		for (size_t page = 0; page < size; page += BENCH_PAGE) block[page] = (char) page;
+
+		if (a->reset) a->reset(state, mark);
+		else a->free(state, block, size);
+
+		bench_sample(t, start);
+	}
+
+	t->operations = operations;
+	return 0;
+}
+
+// Objects allocated by one thread and freed by another
+
+static int xthread_supports(const BenchAllocator *a, unsigned int threads) {
+	return (a->flags & BENCH_ALLOC_SHARED) && threads >= 2;
+}
+
+static rcode xthread_run(BenchRun *run, unsigned int index, void *state) {
+	const BenchAllocator *a = run->allocator;
+	BenchThread *t = &run->thread[index];
+
+	// Threads pair up, and an odd thread out sits idle
+	if (index / 2 >= run->threads / 2) return 0;
+	RingBuffer *ring = &run->rings[index / 2];
+
+	if (!(index % 2)) {
+		for (uint64_t i = 0; i <= run->operations; ++i) {
+			// A null block marks the end of the stream
+			BenchBlock b = {0};
+
+			if (i < run->operations) {
+				b.size = bench_small_size(t);
+
+				uint64_t start = (i % BENCH_SAMPLE_INTERVAL) ? 0 : time_nanoseconds();
+				b.block = a->alloc(state, b.size);
+				if (start) bench_sample(t, start);
+
+				if (!b.block) return DESCENT_ERROR_MEMORY;
+				*(volatile char *) b.block = (char) i;
+			}
+
+			size_t available = 0;
+			void *span = NULL;
+			do span = ring_write_span(ring, &available);
+			while (available < sizeof(BenchBlock));
+
+			memcpy(span, &b, sizeof(BenchBlock));
+			ring_write_commit(ring, sizeof(BenchBlock));
+		}
+
+		t->operations = run->operations;
+		return 0;
+	}
+
+	for (uint64_t i = 0;; ++i) {
+		size_t available = 0;
+		void *span = NULL;
+		do span = ring_read_span(ring, &available);
+		while (available < sizeof(BenchBlock));
+
+		BenchBlock b;
+		memcpy(&b, span, sizeof(BenchBlock));
+		ring_read_consume(ring, sizeof(BenchBlock));
+
+		if (!b.block) break;
+
+		uint64_t start = (i % BENCH_SAMPLE_INTERVAL) ? 0 : time_nanoseconds();
+		a->free(state, b.block, b.size);
+		if (start) bench_sample(t, start);
+	}
+
+	return 0;
+}
+
+static const BenchPattern patterns[] = {
+	{"churn",   churn_supports,   churn_run},
+	{"frame",   frame_supports,   frame_run},
+	{"large",   large_supports,   large_run},
+	{"xthread", xthread_supports, xthread_run},
+};
+
+static const unsigned int pattern_count = sizeof(patterns) / sizeof(patterns[0]);
+
+static int bench_worker(void *argument) {
+	BenchRun *run = argument;
+	unsigned int index = atomic_fetch_add_32(&run->next, 1, ATOMIC_RELAXED);
+	BenchThread *t = &run->thread[index];
+
+	void *state = NULL;
+	t->result = run->allocator->init(&state);
+
+	atomic_fetch_add_32(&run->ready, 1, ATOMIC_RELEASE);
+	futex_wake_all(&run->ready);
+
+	uint32_t go;
+	while (!(go = atomic_load_32(&run->go, ATOMIC_ACQUIRE))) futex_wait(&run->go, 0);
+
+	if (go != BENCH_GO_RUN || t->result) {
+		if (!t->result) run->allocator->release(state);
+		return 1;
+	}
+
+	uint64_t start = time_nanoseconds();
+	t->result = run->pattern->run(run, index, state);
+	t->elapsed = time_nanoseconds() - start;
+
+	rcode result = run->allocator->release(state);
+	if (!t->result) t->result = result;
+
+	return t->result ? 1 : 0;
+}
+
+static int compare_samples(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *samples, size_t count, unsigned int permille) {
+	if (!count) return 0;
+	size_t index = (count - 1) * permille / 1000;
+	return samples[index];
+}
+
+typedef struct {
+	long   faults_minor;
+	long   faults_major;
+	long   maxrss_kib;
+	size_t rss_kib;
+} BenchUsage;
+
+static void bench_usage(BenchUsage *u) {
+	memset(u, 0, sizeof(*u));
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+	struct rusage usage;
+	if (!getrusage(RUSAGE_SELF, &usage)) {
+		u->faults_minor = usage.ru_minflt;
+		u->faults_major = usage.ru_majflt;
+		u->maxrss_kib = usage.ru_maxrss;
+	}
+#endif
+
+#if defined(DESCENT_PLATFORM_LINUX)
+	// Resident set size after the run, which shows memory kept by the allocator
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm) {
+		unsigned long pages = 0, resident = 0;
+		if (fscanf(statm, "%lu %lu", &pages, &resident) == 2) {
+			u->rss_kib = (size_t) resident * (size_t) sysconf(_SC_PAGESIZE) / 1024;
+		}
+		fclose(statm);
+	}
+#endif
+}
+
+static rcode bench_run(const BenchPattern *p, const BenchAllocator *a, unsigned int threads, uint64_t operations) {
+	BenchRun run = {
+		.allocator = a,
+		.pattern = p,
+		.threads = threads,
+		.operations = operations,
+	};
+
+	run.thread = calloc(threads, sizeof(BenchThread));
+	run.rings = calloc(threads / 2 + 1, sizeof(RingBuffer));
+	if (!run.thread || !run.rings) {
+		free(run.thread);
+		free(run.rings);
+		return DESCENT_ERROR_MEMORY;
+	}
+
+	rcode result = 0;
+
+	for (unsigned int i = 0; i < threads && !result; ++i) {
+		run.thread[i].rng = 0x9E3779B97F4A7C15ull * (i + 1);
+		run.thread[i].samples = malloc(BENCH_SAMPLE_MAX * sizeof(uint32_t));
+		if (!run.thread[i].samples) result = DESCENT_ERROR_MEMORY;
+	}
+
+	for (unsigned int i = 0; i < threads / 2 && !result; ++i) {
+		result = ring_init(&run.rings[i], BENCH_RING_SIZE);
+	}
+
+	BenchUsage before, after;
+
+	if (!result) {
+		result = thread_spawn_worker(threads, bench_worker, &run, NULL);
+
+		// Workers that did start are waiting to be released either way
+		if (result) {
+			atomic_store_32(&run.go, BENCH_GO_ABORT, ATOMIC_RELEASE);
+			futex_wake_all(&run.go);
+			thread_collect_worker();
+		}
+	}
+
+	if (!result) {
+		uint32_t ready;
+		while ((ready = atomic_load_32(&run.ready, ATOMIC_ACQUIRE)) < threads) futex_wait(&run.ready, ready);
+
+		bench_usage(&before);
+		atomic_store_32(&run.go, BENCH_GO_RUN, ATOMIC_RELEASE);
+		futex_wake_all(&run.go);
+
+		result = thread_collect_worker();
+		bench_usage(&after);
+	}
+
+	// Merge results
+	uint64_t elapsed = 0, total = 0;
+	size_t sample_count = 0;
+
+	for (unsigned int i = 0; i < threads && !result; ++i) {
+		BenchThread *t = &run.thread[i];
+		if (t->result) result = t->result;
+		if (t->elapsed > elapsed) elapsed = t->elapsed;
+		total += t->operations;
+		sample_count += t->sample_count;
+	}
+
+	uint32_t *samples = result ? NULL : malloc((sample_count + 1) * sizeof(uint32_t));
+	if (!result && !samples) result = DESCENT_ERROR_MEMORY;
+
+	if (!result) {
+		size_t offset = 0;
+		for (unsigned int i = 0; i < threads; ++i) {
+			memcpy(samples + offset, run.thread[i].samples, run.thread[i].sample_count * sizeof(uint32_t));
+			offset += run.thread[i].sample_count;
+		}
+		qsort(samples, sample_count, sizeof(uint32_t), compare_samples);
+
+		double seconds = (double) elapsed / 1e9;
+		printf("%-8s %-16s %7u %14.0f %9u %9u %9u %10u %10ld %8ld %10zu %10ld\n",
+			p->name, a->name, threads,
+			seconds > 0 ? (double) total / seconds : 0.0,
+			percentile(samples, sample_count, 500),
+			percentile(samples, sample_count, 990),
+			percentile(samples, sample_count, 999),
+			sample_count ? samples[sample_count - 1] : 0,
+			after.faults_minor - before.faults_minor,
+			after.faults_major - before.faults_major,
+			after.rss_kib,
+			after.maxrss_kib
+		);
+	}
+	else {
+		printf("%-8s %-16s %7u failed: %s\n", p->name, a->name, threads, rcode_string(result));
+	}
+
+	free(samples);
+	for (unsigned int i = 0; i < threads / 2; ++i) if (run.rings[i]._base) ring_release(&run.rings[i]);
+	for (unsigned int i = 0; i < threads; ++i) free(run.thread[i].samples);
+	free(run.rings);
+	free(run.thread);
+
+	return result;
+}
+
+static rcode parse_unsigned(const char *argument, unsigned int *out) {
+	char *end = NULL;
+	unsigned long value = strtoul(argument, &end, 10);
+	if (!*argument || *end || !value || value > UINT32_MAX) return CLI_ERROR_INCORRECT_ARGUMENT;
+	*out = (unsigned int) value;
+	return 0;
+}
+
+static rcode option_threads(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	return parse_unsigned(argv[0], &((Settings *) settings)->threads);
+}
+
+static rcode option_scale(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	return parse_unsigned(argv[0], &((Settings *) settings)->scale);
+}
+
+static rcode option_pattern(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	((Settings *) settings)->pattern = argv[0];
+	return 0;
+}
+
+static rcode option_allocator(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	((Settings *) settings)->allocator = argv[0];
+	return 0;
+}
+
+int main(int argc, const char **argv) {
+	rcode result = descent_init();
+	if (result) {
+		printf("Initialization failed: %s\n", rcode_string(result));
+		return 1;
+	}
+
+	Settings settings = {
+		.threads = thread_worker_max() < 4 ? thread_worker_max() : 4,
+		.scale = 1,
+	};
+
+	CLI_Parameter parameters[] = {
+		cli_create_option("threads",   't', 1, option_threads),
+		cli_create_option("scale",     's', 1, option_scale),
+		cli_create_option("pattern",   'p', 1, option_pattern),
+		cli_create_option("allocator", 'a', 1, option_allocator),
+	};
+	unsigned int parameter_count = sizeof(parameters) / sizeof(parameters[0]);
+
+	result = cli_parse((unsigned int) argc, argv, parameter_count, parameters, &settings);
+	if (result) {
+		printf("Invalid arguments: %s\n", rcode_string(result));
+		printf("Usage: %s [-t threads] [-s scale] [-p pattern] [-a allocator]\n", argv[0]);
+		return 1;
+	}
+
+	if (settings.threads > thread_worker_max()) settings.threads = thread_worker_max();
+
+	uint64_t operations = (uint64_t) BENCH_OPERATIONS * settings.scale;
+
+	printf("%-8s %-16s %7s %14s %9s %9s %9s %10s %10s %8s %10s %10s\n",
+		"pattern", "allocator", "threads", "ops/s", "p50 ns", "p99 ns", "p999 ns", "max ns",
+		"minflt", "majflt", "rss KiB", "maxrss KiB"
+	);
+
+	int failures = 0;
+
+	for (unsigned int p = 0; p < pattern_count; ++p) {
+		if (settings.pattern && strcmp(settings.pattern, patterns[p].name)) continue;
+
+		for (unsigned int a = 0; a < bench_allocator_count; ++a) {
+			if (settings.allocator && strcmp(settings.allocator, bench_allocators[a].name)) continue;
+
+			// Powers of two up to the maximum, then the maximum itself
+			for (unsigned int threads = 1; threads; threads = (threads == settings.threads) ? 0 : (threads * 2 < settings.threads ? threads * 2 : settings.threads)) {
+				if (!patterns[p].supports(&bench_allocators[a], threads)) continue;
+				if (bench_run(&patterns[p], &bench_allocators[a], threads, operations)) ++failures;
+			}
+		}
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <descent/cli.h>
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/mutex.h>
+#include <descent/thread/thread.h>
+#include <descent/time.h>
+
+// Timed acquisitions per thread at scale 1
+#define BENCH_SAMPLES 4096u
+
+// In the even pattern, one acquisition in every BENCH_SAMPLE_INTERVAL is timed
+#define BENCH_SAMPLE_INTERVAL 64u
+
+// The hot thread holds the lock for long sections and relocks at once, while
+// the others lock briefly at intervals, as a game thread and its helpers might
+#define BENCH_HOT_HOLD  20000u
+#define BENCH_COLD_HOLD 2000u
+#define BENCH_COLD_GAP  50000u
+#define BENCH_EVEN_HOLD 100u
+
+#define BENCH_GO_RUN   1u
+#define BENCH_GO_ABORT 2u
+
+typedef struct {
+	uint64_t  operations;
+	uint32_t *samples;
+	size_t    sample_count;
+} BenchThread;
+
+struct BenchPattern;
+
+typedef struct {
+	const struct BenchPattern *pattern;
+	unsigned int               threads;
+	uint64_t                   samples;
+	struct Mutex               mutex;
+	atomic_32                  next;
+	atomic_32                  ready;
+	atomic_32                  go;
+	atomic_32                  stop;
+	atomic_32                  done;
+	BenchThread               *thread;
+} BenchRun;
+
+typedef struct BenchPattern {
+	const char  *name;
+	unsigned int min_threads;
+	void       (*run)(BenchRun *run, unsigned int index);
+} BenchPattern;
+
+typedef struct {
+	unsigned int threads;
+	unsigned int scale;
+	const char  *pattern;
+} Settings;
+
+static volatile uint64_t bench_sink;
+
+// Busy-waits, standing in for work done under the lock
+static void bench_work(uint64_t nanoseconds) {
+	uint64_t start = time_nanoseconds();
+	while (time_nanoseconds() - start < nanoseconds) ++bench_sink;
+}
+
+// Sleeps without holding the lock, by waiting on a futex nobody wakes
+static void bench_sleep(uint64_t nanoseconds) {
+	atomic_32 never = ATOMIC_INIT(0);
+	futex_timedwait(&never, 0, nanoseconds);
+}
+
+static inline void bench_sample(BenchThread *t, uint64_t start) {
+	uint64_t elapsed = time_nanoseconds() - start;
+	t->samples[t->sample_count++] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t) elapsed;
+}
+
+// One thread keeps the lock busy, and the others measure how long they wait
+
+static void hot_run(BenchRun *run, unsigned int index) {
+	BenchThread *t = &run->thread[index];
+
+	if (!index) {
+		while (!atomic_load_32(&run->stop, ATOMIC_RELAXED)) {
+			mutex_lock(&run->mutex);
+			bench_work(BENCH_HOT_HOLD);
+			mutex_unlock(&run->mutex);
+			++t->operations;
+		}
+		return;
+	}
+
+	for (uint64_t i = 0; i < run->samples; ++i) {
+		uint64_t start = time_nanoseconds();
+		mutex_lock(&run->mutex);
+		bench_sample(t, start);
+
+		bench_work(BENCH_COLD_HOLD);
+		mutex_unlock(&run->mutex);
+		++t->operations;
+
+		bench_sleep(BENCH_COLD_GAP);
+	}
+
+	// The last cold thread to finish stops the hot thread
+	if (atomic_add_fetch_32(&run->done, 1, ATOMIC_RELAXED) == run->threads - 1) {
+		atomic_store_32(&run->stop, 1, ATOMIC_RELAXED);
+	}
+}
+
+// Every thread locks back to back with short sections
+
+static void even_run(BenchRun *run, unsigned int index) {
+	BenchThread *t = &run->thread[index];
+	uint64_t operations = run->samples * BENCH_SAMPLE_INTERVAL;
+
+	for (uint64_t i = 0; i < operations; ++i) {
+		uint64_t start = (i % BENCH_SAMPLE_INTERVAL) ? 0 : time_nanoseconds();
+		mutex_lock(&run->mutex);
+		if (start) bench_sample(t, start);
+
+		bench_work(BENCH_EVEN_HOLD);
+		mutex_unlock(&run->mutex);
+	}
+
+	t->operations = operations;
+}
+
+static const BenchPattern patterns[] = {
+	{"hot",  2, hot_run},
+	{"even", 1, even_run},
+};
+
+static const unsigned int pattern_count = sizeof(patterns) / sizeof(patterns[0]);
+
+static int bench_worker(void *argument) {
+	BenchRun *run = argument;
+	unsigned int index = atomic_fetch_add_32(&run->next, 1, ATOMIC_RELAXED);
+
+	atomic_fetch_add_32(&run->ready, 1, ATOMIC_RELEASE);
+	futex_wake_all(&run->ready);
+
+	uint32_t go;
+	while (!(go = atomic_load_32(&run->go, ATOMIC_ACQUIRE))) futex_wait(&run->go, 0);
+	if (go != BENCH_GO_RUN) return 1;
+
+	run->pattern->run(run, index);
+	return 0;
+}
+
+static int compare_samples(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *samples, size_t count, unsigned int permille) {
+	if (!count) return 0;
+	size_t index = (count - 1) * permille / 1000;
+	return samples[index];
+}
+
+static rcode bench_run(const BenchPattern *p, unsigned int threads, uint64_t samples) {
+	BenchRun run = {
+		.pattern = p,
+		.threads = threads,
+		.samples = samples,
+		.mutex = MUTEX_INIT,
+	};
+
+	run.thread = calloc(threads, sizeof(BenchThread));
+	if (!run.thread) return DESCENT_ERROR_MEMORY;
+
+	rcode result = 0;
+
+	for (unsigned int i = 0; i < threads && !result; ++i) {
+		run.thread[i].samples = malloc(samples * sizeof(uint32_t));
+		if (!run.thread[i].samples) result = DESCENT_ERROR_MEMORY;
+	}
+
+	uint64_t elapsed = 0;
+
+	if (!result) {
+		result = thread_spawn_worker(threads, bench_worker, &run, NULL);
+
+		// Workers that did start are waiting to be released either way
+		if (result) {
+			atomic_store_32(&run.go, BENCH_GO_ABORT, ATOMIC_RELEASE);
+			futex_wake_all(&run.go);
+			thread_collect_worker();
+		}
+	}
+
+	if (!result) {
+		uint32_t ready;
+		while ((ready = atomic_load_32(&run.ready, ATOMIC_ACQUIRE)) < threads) futex_wait(&run.ready, ready);
+
+		uint64_t start = time_nanoseconds();
+		atomic_store_32(&run.go, BENCH_GO_RUN, ATOMIC_RELEASE);
+		futex_wake_all(&run.go);
+
+		result = thread_collect_worker();
+		elapsed = time_nanoseconds() - start;
+	}
+
+	// Merge results
+	uint64_t total = 0;
+	size_t sample_count = 0;
+
+	for (unsigned int i = 0; i < threads && !result; ++i) {
+		total += run.thread[i].operations;
+		sample_count += run.thread[i].sample_count;
+	}
+
+	uint32_t *merged = result ? NULL : malloc((sample_count + 1) * sizeof(uint32_t));
+	if (!result && !merged) result = DESCENT_ERROR_MEMORY;
+
+	if (!result) {
+		size_t offset = 0;
+		for (unsigned int i = 0; i < threads; ++i) {
+			memcpy(merged + offset, run.thread[i].samples, run.thread[i].sample_count * sizeof(uint32_t));
+			offset += run.thread[i].sample_count;
+		}
+		qsort(merged, sample_count, sizeof(uint32_t), compare_samples);
+
+		double seconds = (double) elapsed / 1e9;
+		printf("%-8s %7u %14.0f %9u %9u %9u %10u\n",
+			p->name, threads,
+			seconds > 0 ? (double) total / seconds : 0.0,
+			percentile(merged, sample_count, 500),
+			percentile(merged, sample_count, 990),
+			percentile(merged, sample_count, 999),
+			sample_count ? merged[sample_count - 1] : 0
+		);
+	}
+	else {
+		printf("%-8s %7u failed: %s\n", p->name, threads, rcode_string(result));
+	}
+
+	free(merged);
+	for (unsigned int i = 0; i < threads; ++i) free(run.thread[i].samples);
+	free(run.thread);
+
+	return result;
+}
+
+static rcode parse_unsigned(const char *argument, unsigned int *out) {
+	char *end = NULL;
+	unsigned long value = strtoul(argument, &end, 10);
+	if (!*argument || *end || !value || value > UINT32_MAX) return CLI_ERROR_INCORRECT_ARGUMENT;
+	*out = (unsigned int) value;
+	return 0;
+}
+
+static rcode option_threads(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	return parse_unsigned(argv[0], &((Settings *) settings)->threads);
+}
+
+static rcode option_scale(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	return parse_unsigned(argv[0], &((Settings *) settings)->scale);
+}
+
+static rcode option_pattern(unsigned int argc, const char **argv, void *settings) {
+	(void) argc;
+	((Settings *) settings)->pattern = argv[0];
+	return 0;
+}
+
+int main(int argc, const char **argv) {
+	rcode result = descent_init();
+	if (result) {
+		printf("Initialization failed: %s\n", rcode_string(result));
+		return 1;
+	}
+
+	Settings settings = {
+		.threads = thread_worker_max() < 4 ? thread_worker_max() : 4,
+		.scale = 1,
+	};
+
+	CLI_Parameter parameters[] = {
+		cli_create_option("threads", 't', 1, option_threads),
+		cli_create_option("scale",   's', 1, option_scale),
+		cli_create_option("pattern", 'p', 1, option_pattern),
+	};
+	unsigned int parameter_count = sizeof(parameters) / sizeof(parameters[0]);
+
+	result = cli_parse((unsigned int) argc, argv, parameter_count, parameters, &settings);
+	if (result) {
+		printf("Invalid arguments: %s\n", rcode_string(result));
+		printf("Usage: %s [-t threads] [-s scale] [-p pattern]\n", argv[0]);
+		return 1;
+	}
+
+	if (settings.threads > thread_worker_max()) settings.threads = thread_worker_max();
+
+	uint64_t samples = (uint64_t) BENCH_SAMPLES * settings.scale;
+
+	// Latencies are of acquisitions, and the hot thread's are not timed
+	printf("%-8s %7s %14s %9s %9s %9s %10s\n",
+		"pattern", "threads", "locks/s", "p50 ns", "p99 ns", "p999 ns", "max ns"
+	);
+
+	int failures = 0;
+
+	for (unsigned int p = 0; p < pattern_count; ++p) {
+		if (settings.pattern && strcmp(settings.pattern, patterns[p].name)) continue;
+
+		// Powers of two up to the maximum, then the maximum itself
+		for (unsigned int threads = 1; threads; threads = (threads == settings.threads) ? 0 : (threads * 2 < settings.threads ? threads * 2 : settings.threads)) {
+			if (threads < patterns[p].min_threads) continue;
+			if (bench_run(&patterns[p], threads, samples)) ++failures;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
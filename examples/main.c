@@ -56,10 +56,10 @@ int main(void) {
 
 	descent_init();
 
-	printf("spawn render:    %s\n", rcode_string(thread_spawn_unique(0, render_function, NULL, "Render")));
-	printf("spawn audio:     %s\n", rcode_string(thread_spawn_unique(1, audio_function, NULL, "Audio")));
-	printf("spawn network:   %s\n", rcode_string(thread_spawn_unique(2, network_function, NULL, "Network")));
-	printf("spawn worker:    %s\n", rcode_string(thread_spawn_worker(12, worker_function, NULL)));
+	printf("spawn render:    %s\n", rcode_string(thread_spawn_unique(0, render_function, NULL, "Render", NULL)));
+	printf("spawn audio:     %s\n", rcode_string(thread_spawn_unique(1, audio_function, NULL, "Audio", NULL)));
+	printf("spawn network:   %s\n", rcode_string(thread_spawn_unique(2, network_function, NULL, "Network", NULL)));
+	printf("spawn worker:    %s\n", rcode_string(thread_spawn_worker(12, worker_function, NULL, NULL)));
 	printf("collect render:  %s\n", rcode_string(thread_collect_unique(0)));
 	printf("collect audio:   %s\n", rcode_string(thread_collect_unique(1)));
 	printf("collect network: %s\n", rcode_string(thread_collect_unique(2)));
@@ -145,18 +145,6 @@ int main(void) {
 }
 
 /*
-static void *lua_malloc_wrapper(void *ud, void *ptr, size_t osize, size_t nsize) {
-	(void)ud;    // unused
-	(void)osize; // Lua may pass old size, we don't need it for malloc/realloc
-
-	if (nsize == 0) {
-		free(ptr);
-		return NULL;
-	} else {
-		return realloc(ptr, nsize);
-	}
-}
-
 atomic_32 do_logging = 1;
 
 int tf(void *arg) {
@@ -195,7 +183,12 @@ int main(void) {
 	e = thread_create(&t, tf, NULL, NULL);
 	if (e) printf("Could not create new thread (%s)\n", code_string(e));
 
-	run_lua_script("../../game_logic.lua", lua_malloc_wrapper, NULL);
+	ScriptAllocator script_allocator;
+	e = script_allocator_init(&script_allocator, 0);
+	if (e) printf("Could not initialize script allocator (%s)\n", code_string(e));
+
+	run_lua_script("../../game_logic.lua", script_allocator_lua, &script_allocator);
+	script_allocator_release(&script_allocator);
 
 	for (int i = 0; i < MODULE_COUNT; ++i) log_message(i, LOG_LEVEL_TRACE, "HELLO");
 
@@ -16,6 +16,10 @@
 #ifndef DESCENT_ALLOC_H
 #define DESCENT_ALLOC_H
 
+#include "alloc/ring.h"
+#include "alloc/slotmap.h"
+#include "alloc/stackalloc.h"
 #include "alloc/sysalloc.h"
+#include "alloc/varray.h"
 
 #endif
\ No newline at end of file
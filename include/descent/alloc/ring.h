@@ -0,0 +1,123 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_RING_H
+#define DESCENT_RING_H
+
+#include <stddef.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+#include <descent/utilities/platform.h>
+
+/**
+ * @struct RingBuffer
+ * @brief A byte ring buffer whose memory is mapped twice, back-to-back.
+ *
+ * The second mapping mirrors the first, so any span of up to the buffer's
+ * capacity is contiguous in memory, even when it crosses the end of the
+ * buffer. Producers and consumers can work on spans in place, without
+ * splitting or copying at the wrap point.
+ *
+ * One producer thread and one consumer thread may use the buffer concurrently.
+ * Multiple producers or consumers must be serialized externally.
+ *
+ * Must be initialized with @ref ring_init() before use.
+ */
+typedef struct {
+	void     *_base;
+	size_t    _capacity;
+	atomic_64 _head;
+	char      _pad[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+	atomic_64 _tail;
+} RingBuffer;
+
+/**
+ * @brief Initializes a ring buffer.
+ * @param r Pointer to the ring buffer.
+ * @param capacity The minimum capacity of the buffer in bytes. Rounded up to
+ * the allocation granularity.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p r is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p capacity is 0.
+ * - @ref DESCENT_ERROR_OVERFLOW if the mapping would exceed @ref DESCENT_MAX_ALLOC.
+ * - @ref DESCENT_ERROR_MEMORY if memory could not be allocated.
+ * - @ref DESCENT_ERROR_UNSUPPORTED if the platform cannot double-map memory.
+ * - @ref DESCENT_ERROR_OS on any other system error.
+ */
+rcode ring_init(RingBuffer *r, size_t capacity);
+
+/**
+ * @brief Releases a ring buffer's memory.
+ * @param r Pointer to the ring buffer.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p r is NULL.
+ * - @ref ALLOCATOR_ERROR_FREE if the buffer was not initialized.
+ * - @ref DESCENT_ERROR_OS on any other system error.
+ */
+rcode ring_release(RingBuffer *r);
+
+/**
+ * @brief Gets the free span at the tail of the buffer. Producer only.
+ * @param r Pointer to the ring buffer.
+ * @param size Receives the size of the span in bytes.
+ * @return A pointer to the contiguous free span.
+ */
+void *ring_write_span(RingBuffer *r, size_t *size);
+
+/**
+ * @brief Publishes bytes written to the free span to the consumer. Producer
+ * only.
+ * @param r Pointer to the ring buffer.
+ * @param size The number of bytes to publish.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p r is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if @p size exceeds the free space.
+ */
+rcode ring_write_commit(RingBuffer *r, size_t size);
+
+/**
+ * @brief Gets the filled span at the head of the buffer. Consumer only.
+ * @param r Pointer to the ring buffer.
+ * @param size Receives the size of the span in bytes.
+ * @return A pointer to the contiguous filled span.
+ */
+void *ring_read_span(RingBuffer *r, size_t *size);
+
+/**
+ * @brief Releases bytes read from the filled span back to the producer.
+ * Consumer only.
+ * @param r Pointer to the ring buffer.
+ * @param size The number of bytes to release.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p r is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if @p size exceeds the filled space.
+ */
+rcode ring_read_consume(RingBuffer *r, size_t size);
+
+/**
+ * @brief Gets the capacity of a ring buffer.
+ * @param r Pointer to the ring buffer.
+ * @return The capacity of the buffer in bytes.
+ */
+static inline size_t ring_capacity(const RingBuffer *r) {
+	return r->_capacity;
+}
+
+#endif
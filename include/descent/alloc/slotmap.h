@@ -0,0 +1,176 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_SLOTMAP_H
+#define DESCENT_SLOTMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/alloc/varray.h>
+#include <descent/rcode.h>
+
+// Define DESCENT_SLOT_HANDLE_32 to use 32-bit handles, with 20 index bits and
+// 12 generation bits. 64-bit handles use 32 bits for each.
+#if defined(DESCENT_SLOT_HANDLE_32)
+typedef uint32_t slot_handle;
+#define SLOT_INDEX_BITS 20u
+#else
+typedef uint64_t slot_handle;
+#define SLOT_INDEX_BITS 32u
+#endif
+
+#define SLOT_GENERATION_BITS (sizeof(slot_handle) * 8u - SLOT_INDEX_BITS)
+#define SLOT_INDEX_MASK      ((slot_handle) (((uint64_t) 1 << SLOT_INDEX_BITS) - 1u))
+#define SLOT_GENERATION_MASK ((uint32_t) (((uint64_t) 1 << SLOT_GENERATION_BITS) - 1u))
+
+// Generations start at 1, so no valid handle is ever 0
+#define SLOT_HANDLE_NONE ((slot_handle) 0)
+
+/**
+ * @brief The maximum number of elements in a slot map.
+ */
+#define SLOTMAP_CAPACITY_MAX ((size_t) SLOT_INDEX_MASK)
+
+typedef struct {
+	uint32_t dense;      // Dense index if live, next free slot otherwise
+	uint32_t generation;
+} SlotmapSlot;
+
+/**
+ * @struct Slotmap
+ * @brief A densely-packed object table addressed by generational handles.
+ *
+ * Elements are stored contiguously in insertion order, except that removing
+ * an element moves the last element into its place. Callers hold handles
+ * instead of pointers. A handle records the generation of its slot, which
+ * changes when the element is removed, so stale handles are detected with a
+ * single comparison.
+ *
+ * Storage is made of virtual arrays, so the slot map never copies on growth.
+ * Element pointers remain valid until an element is removed.
+ *
+ * A slot map is not thread-safe.
+ *
+ * Must be initialized with @ref slotmap_init() before use.
+ */
+typedef struct {
+	VArray   _dense;
+	VArray   _owners;
+	VArray   _slots;
+	uint32_t _free;
+} Slotmap;
+
+/**
+ * @brief Initializes a slot map.
+ * @param m Pointer to the slot map.
+ * @param element_size The size of each element, in bytes.
+ * @param capacity The maximum number of elements.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p m is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p element_size or @p capacity is 0.
+ * - @ref DESCENT_ERROR_OVERFLOW if @p capacity exceeds @ref SLOTMAP_CAPACITY_MAX.
+ * - Any error returned by @ref varray_init.
+ */
+rcode slotmap_init(Slotmap *m, size_t element_size, size_t capacity);
+
+/**
+ * @brief Releases a slot map and all of its memory.
+ * @param m Pointer to the slot map.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p m is NULL.
+ * - Any error returned by @ref varray_release.
+ */
+rcode slotmap_release(Slotmap *m);
+
+/**
+ * @brief Inserts an element into a slot map.
+ * @param m Pointer to the slot map.
+ * @param element The element to copy into the slot map, or NULL to zero it.
+ * @param handle Receives the element's handle.
+ * @param out If not NULL, receives a pointer to the element.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p m or @p handle is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if the slot map is full.
+ * - Any error returned by @ref varray_push.
+ */
+rcode slotmap_insert(Slotmap *m, const void *element, slot_handle *handle, void **out);
+
+/**
+ * @brief Removes an element from a slot map, moving the last element into
+ * its place.
+ * @param m Pointer to the slot map.
+ * @param handle The element's handle.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p m is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p handle is stale or invalid.
+ */
+rcode slotmap_remove(Slotmap *m, slot_handle handle);
+
+/**
+ * @brief Gets the slot of a handle if the handle is live.
+ * @param m Pointer to the slot map.
+ * @param handle The handle.
+ * @return A pointer to the slot, or NULL if @p handle is stale or invalid.
+ */
+static inline SlotmapSlot *slotmap_slot(const Slotmap *m, slot_handle handle) {
+	SlotmapSlot *slot = varray_at(&m->_slots, (size_t) (handle & SLOT_INDEX_MASK));
+	if (!slot || slot->generation != (uint32_t) (handle >> SLOT_INDEX_BITS)) return NULL;
+	return slot;
+}
+
+/**
+ * @brief Gets the element of a handle.
+ * @param m Pointer to the slot map.
+ * @param handle The handle.
+ * @return A pointer to the element, or NULL if @p handle is stale or invalid.
+ */
+static inline void *slotmap_get(const Slotmap *m, slot_handle handle) {
+	SlotmapSlot *slot = slotmap_slot(m, handle);
+	return slot ? varray_at(&m->_dense, slot->dense) : NULL;
+}
+
+/**
+ * @brief Gets the number of elements in a slot map.
+ * @param m Pointer to the slot map.
+ * @return The number of elements.
+ */
+static inline size_t slotmap_count(const Slotmap *m) {
+	return varray_count(&m->_dense);
+}
+
+/**
+ * @brief Gets the densely-packed elements of a slot map, for iteration.
+ * @param m Pointer to the slot map.
+ * @return A pointer to the first of @ref slotmap_count() elements.
+ */
+static inline void *slotmap_data(const Slotmap *m) {
+	return varray_data(&m->_dense);
+}
+
+/**
+ * @brief Gets the handle of an element by its position in the dense array.
+ * @param m Pointer to the slot map.
+ * @param index The position of the element.
+ * @return The element's handle, or @ref SLOT_HANDLE_NONE if @p index is out
+ * of range.
+ */
+slot_handle slotmap_handle_at(const Slotmap *m, size_t index);
+
+#endif
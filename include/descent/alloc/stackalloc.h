@@ -0,0 +1,160 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_STACKALLOC_H
+#define DESCENT_STACKALLOC_H
+
+#include <stddef.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+
+/**
+ * @brief Size of the reservation behind each thread's stack allocator.
+ */
+#ifndef DESCENT_STACKALLOC_THREAD_SIZE
+#define DESCENT_STACKALLOC_THREAD_SIZE 0x1000000ULL
+#endif
+
+/**
+ * @brief Minimum number of bytes committed each time a stack allocator grows.
+ * Must be a power of two. Rounded up to the allocation granularity.
+ */
+#ifndef DESCENT_STACKALLOC_COMMIT_STEP
+#define DESCENT_STACKALLOC_COMMIT_STEP 0x10000ULL
+#endif
+
+/**
+ * @struct Stackalloc
+ * @brief A last-in, first-out allocator for scoped scratch memory.
+ *
+ * Allocations are carved from the top of a reservation, which is committed as
+ * it grows. Scopes save a marker with @ref stackalloc_push() and free
+ * everything allocated since with @ref stackalloc_pop(), so nested scopes free
+ * their memory in reverse order at no cost.
+ *
+ * A stack allocator is not thread-safe. Each managed thread, and each job
+ * fiber, has its own instance, available through @ref stackalloc_self().
+ *
+ * Must be initialized with @ref stackalloc_init() before use.
+ */
+typedef struct {
+	Sysalloc _reservation;
+	size_t   _committed;
+	size_t   _top;
+} Stackalloc;
+
+/**
+ * @brief A saved position in a stack allocator.
+ */
+typedef size_t StackallocMarker;
+
+/**
+ * @brief Initializes a stack allocator, reserving @p size bytes.
+ * @param s Pointer to the stack allocator.
+ * @param size The maximum number of bytes the allocator can hold. Rounded up
+ * to the allocation granularity.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s is NULL.
+ * - Any error returned by @ref sysalloc_reserve.
+ */
+rcode stackalloc_init(Stackalloc *s, size_t size);
+
+/**
+ * @brief Releases a stack allocator and all of its memory.
+ * @param s Pointer to the stack allocator.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s is NULL.
+ * - Any error returned by @ref sysfree.
+ */
+rcode stackalloc_release(Stackalloc *s);
+
+/**
+ * @brief Allocates memory from the top of a stack allocator.
+ * @param s Pointer to the stack allocator.
+ * @param size The number of bytes to allocate.
+ * @param align The alignment of the allocation. Must be a power of two, and may
+ * exceed the allocation granularity, at the cost of the padding before it.
+ * @param out Receives a pointer to the allocation.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s or @p out is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p align is not a power of two.
+ * - @ref DESCENT_ERROR_OVERFLOW if the allocation does not fit in the reservation.
+ * - Any error returned by @ref sysalloc_commit.
+ */
+rcode stackalloc(Stackalloc *s, size_t size, size_t align, void **out);
+
+/**
+ * @brief Saves the current top of a stack allocator.
+ * @param s Pointer to the stack allocator.
+ * @return A marker for @ref stackalloc_pop().
+ */
+static inline StackallocMarker stackalloc_push(const Stackalloc *s) {
+	return s->_top;
+}
+
+/**
+ * @brief Frees everything allocated since a marker was saved.
+ *
+ * Memory stays committed for reuse until @ref stackalloc_trim() is called.
+ *
+ * @param s Pointer to the stack allocator.
+ * @param marker A marker returned by @ref stackalloc_push().
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p marker is above the top of the allocator,
+ *   which means it was already popped.
+ */
+rcode stackalloc_pop(Stackalloc *s, StackallocMarker marker);
+
+/**
+ * @brief Decommits memory above the top of a stack allocator.
+ * @param s Pointer to the stack allocator.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s is NULL.
+ * - Any error returned by @ref sysalloc_decommit.
+ */
+rcode stackalloc_trim(Stackalloc *s);
+
+/**
+ * @brief Gets the calling thread's stack allocator.
+ *
+ * Each managed thread has its own instance of
+ * @ref DESCENT_STACKALLOC_THREAD_SIZE bytes, which is reserved on first use.
+ * It is kept after the thread exits, and reused by the next thread with the
+ * same thread ID.
+ *
+ * Within a job running on a fiber, the fiber's own instance is returned
+ * instead, since the job may resume on another thread after @ref job_wait()
+ * while other jobs use this thread's instance.
+ *
+ * @warning The allocator must only be used by the job or thread which got it.
+ * Jobs it is passed to may run on other threads or fibers.
+ *
+ * @param s Receives a pointer to the calling thread's stack allocator.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p s is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ * - Any error returned by @ref stackalloc_init.
+ */
+rcode stackalloc_self(Stackalloc **s);
+
+#endif
@@ -0,0 +1,185 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_VARRAY_H
+#define DESCENT_VARRAY_H
+
+#include <stddef.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+
+/**
+ * @brief Minimum number of bytes committed each time a virtual array grows.
+ * Must be a power of two. Rounded up to the allocation granularity.
+ */
+#ifndef DESCENT_VARRAY_COMMIT_STEP
+#define DESCENT_VARRAY_COMMIT_STEP 0x10000ULL
+#endif
+
+/**
+ * @struct VArray
+ * @brief A growable array backed by a virtual memory reservation.
+ *
+ * Address space for the maximum number of elements is reserved up front, and
+ * pages are committed as the array grows. Growth never moves the array, so
+ * pointers to elements remain valid until the array is released, and there is
+ * no copy or doubled peak memory when the array grows.
+ *
+ * The first element is aligned to the allocation granularity.
+ *
+ * A virtual array is not thread-safe.
+ *
+ * Must be initialized with @ref varray_init() before use.
+ */
+typedef struct {
+	Sysalloc _reservation;
+	size_t   _element_size;
+	size_t   _capacity;
+	size_t   _committed;
+	size_t   _count;
+} VArray;
+
+/**
+ * @brief Initializes a virtual array, reserving space for @p capacity elements.
+ *
+ * No memory is committed until elements are added.
+ *
+ * @param v Pointer to the array.
+ * @param element_size The size of each element, in bytes.
+ * @param capacity The maximum number of elements.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p element_size or @p capacity is 0.
+ * - @ref DESCENT_ERROR_OVERFLOW if the reservation would exceed @ref DESCENT_MAX_ALLOC.
+ * - Any error returned by @ref sysalloc_reserve.
+ */
+rcode varray_init(VArray *v, size_t element_size, size_t capacity);
+
+/**
+ * @brief Releases a virtual array and all of its memory.
+ * @param v Pointer to the array.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - Any error returned by @ref sysfree.
+ */
+rcode varray_release(VArray *v);
+
+/**
+ * @brief Commits memory for at least @p count elements without changing the
+ * number of elements in the array.
+ * @param v Pointer to the array.
+ * @param count The number of elements to commit memory for.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if @p count exceeds the capacity of the array.
+ * - Any error returned by @ref sysalloc_commit.
+ */
+rcode varray_reserve(VArray *v, size_t count);
+
+/**
+ * @brief Changes the number of elements in the array.
+ *
+ * New elements are zeroed. Removed elements are discarded, but their memory
+ * stays committed until @ref varray_shrink() is called.
+ *
+ * @param v Pointer to the array.
+ * @param count The new number of elements.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if @p count exceeds the capacity of the array.
+ * - Any error returned by @ref sysalloc_commit.
+ */
+rcode varray_resize(VArray *v, size_t count);
+
+/**
+ * @brief Appends elements to the end of the array.
+ * @param v Pointer to the array.
+ * @param count The number of elements to append.
+ * @param elements The elements to copy into the array, or NULL to zero them.
+ * @param first If not NULL, receives a pointer to the first appended element.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - @ref DESCENT_ERROR_OVERFLOW if the array would exceed its capacity.
+ * - Any error returned by @ref sysalloc_commit.
+ */
+rcode varray_push(VArray *v, size_t count, const void *elements, void **first);
+
+/**
+ * @brief Removes the last element of the array.
+ * @param v Pointer to the array.
+ * @param element If not NULL, receives a copy of the removed element.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - @ref DESCENT_ERROR_STATE if the array is empty.
+ */
+rcode varray_pop(VArray *v, void *element);
+
+/**
+ * @brief Decommits memory that is no longer needed by the elements in the
+ * array.
+ * @param v Pointer to the array.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p v is NULL.
+ * - Any error returned by @ref sysalloc_decommit.
+ */
+rcode varray_shrink(VArray *v);
+
+/**
+ * @brief Gets a pointer to an element of the array.
+ * @param v Pointer to the array.
+ * @param index The index of the element.
+ * @return A pointer to the element, or NULL if @p index is out of range.
+ */
+static inline void *varray_at(const VArray *v, size_t index) {
+	if (index >= v->_count) return NULL;
+	return (char *) v->_reservation.base + index * v->_element_size;
+}
+
+/**
+ * @brief Gets a pointer to the first element of the array, which never moves.
+ * @param v Pointer to the array.
+ * @return A pointer to the first element.
+ */
+static inline void *varray_data(const VArray *v) {
+	return v->_reservation.base;
+}
+
+/**
+ * @brief Gets the number of elements in the array.
+ * @param v Pointer to the array.
+ * @return The number of elements in the array.
+ */
+static inline size_t varray_count(const VArray *v) {
+	return v->_count;
+}
+
+/**
+ * @brief Gets the maximum number of elements the array can hold.
+ * @param v Pointer to the array.
+ * @return The capacity of the array.
+ */
+static inline size_t varray_capacity(const VArray *v) {
+	return v->_capacity;
+}
+
+#endif
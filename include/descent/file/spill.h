@@ -0,0 +1,124 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_FILE_SPILL_H
+#define DESCENT_FILE_SPILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+	SPILL_MODE_TEMPORARY = 0,      // Contents are discarded when the arena is closed.
+	SPILL_MODE_PERSIST   = 1 << 0, // Contents are kept, and restored when the file is opened again.
+};
+
+/**
+ * @brief A bump arena backed by a memory-mapped file.
+ *
+ * The arena's memory is a shared mapping of a file, usually under //CACHE/ or
+ * //TEMP/, so it is paged in and out by the OS instead of committing RAM. It
+ * suits large, cold data that is rarely touched, such as baked navigation data
+ * or replay buffers.
+ *
+ * A persistent arena keeps its contents and allocation offset between runs.
+ * The mapping address changes between runs, so data stored in the arena
+ * should refer to other data in it by offset, not by pointer.
+ *
+ * Temporary arenas are unlinked as soon as they are opened on POSIX. On
+ * Windows, mapped files cannot be deleted, so their file is left in place and
+ * truncated when it is next opened.
+ *
+ * A spill arena is not thread-safe.
+ */
+typedef struct {
+	void     *_base;
+	size_t    _size;
+	uintptr_t _handle;
+	uintptr_t _mapping;
+} SpillArena;
+
+/**
+ * @brief Opens a spill arena, creating its file if needed.
+ * @param s Pointer to the arena.
+ * @param dpath The path of the backing file.
+ * @param size The size of the arena in bytes, including a small header.
+ * Rounded up to the allocation granularity. A persistent arena that already
+ * exists keeps its contents if it is reopened with the same size, or grows
+ * if it is reopened with a larger size. It cannot be reopened with a smaller
+ * size.
+ * @param mode One of the SPILL_MODE values.
+ * @return 0 on success, error code otherwise. Returns DESCENT_ERROR_INVALID,
+ * leaving the file untouched, if a persistent arena already exists with a
+ * larger size.
+ */
+int spill_open(SpillArena *s, const char *dpath, size_t size, int mode);
+
+/**
+ * @brief Unmaps a spill arena and closes its file.
+ * @param s Pointer to the arena.
+ * @return 0 on success, error code otherwise.
+ */
+int spill_close(SpillArena *s);
+
+/**
+ * @brief Allocates memory from a spill arena.
+ * @param s Pointer to the arena.
+ * @param size The number of bytes to allocate.
+ * @param align The alignment of the allocation. Must be a power of two no
+ * greater than the allocation granularity.
+ * @param out Receives a pointer to the allocation.
+ * @return 0 on success, error code otherwise.
+ */
+int spill_alloc(SpillArena *s, size_t size, size_t align, void **out);
+
+/**
+ * @brief Frees every allocation in a spill arena.
+ * @param s Pointer to the arena.
+ * @return 0 on success, error code otherwise.
+ */
+int spill_reset(SpillArena *s);
+
+/**
+ * @brief Writes modified pages of a spill arena back to its file.
+ *
+ * The OS writes pages back on its own schedule, so this is only needed before
+ * the data must survive a crash.
+ *
+ * @param s Pointer to the arena.
+ * @return 0 on success, error code otherwise.
+ */
+int spill_sync(SpillArena *s);
+
+/**
+ * @brief Gets the offset of an allocation from the start of the arena.
+ * @param s Pointer to the arena.
+ * @param p Pointer into the arena.
+ * @return The offset of @p p.
+ */
+static inline size_t spill_offset(const SpillArena *s, const void *p) {
+	return (size_t) ((const char *) p - (const char *) s->_base);
+}
+
+/**
+ * @brief Gets a pointer from an offset returned by @ref spill_offset().
+ * @param s Pointer to the arena.
+ * @param offset The offset.
+ * @return A pointer into the arena.
+ */
+static inline void *spill_pointer(const SpillArena *s, size_t offset) {
+	return (char *) s->_base + offset;
+}
+
+#endif
@@ -0,0 +1,33 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ==================================================== *
+ *  THIS FILE IS AUTOGENERATED — DO NOT EDIT            *
+ *                                                      *
+ *  Generated by CMake from config/metadata.h.in        *
+ *  Any changes made to this file will be overwritten.  *
+ *  Placed in include/descent/metadata.h                *
+ * ==================================================== */
+
+#ifndef DESCENT_METADATA_H
+#define DESCENT_METADATA_H
+
+#define DESCENT_VERSION_MAJOR   0
+#define DESCENT_VERSION_MINOR   0
+#define DESCENT_VERSION_PATCH   0
+#define DESCENT_VERSION_VARIANT "dev"
+#define DESCENT_VERSION_STRING  "0.0.0-dev"
+
+#endif
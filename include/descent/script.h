@@ -18,6 +18,8 @@
 
 #include <lua.h>
 
+#include <descent/script/alloc.h>
+
 typedef enum {
 	SCRIPT_ERROR_UNKNOWN = -1,
 	SCRIPT_SUCCESS = 0,
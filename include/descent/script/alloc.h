@@ -0,0 +1,136 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_SCRIPT_ALLOC_H
+#define DESCENT_SCRIPT_ALLOC_H
+
+#include <stddef.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+
+/**
+ * @brief Default memory limit of a script allocator, in bytes.
+ */
+#ifndef DESCENT_SCRIPT_ALLOC_LIMIT
+#define DESCENT_SCRIPT_ALLOC_LIMIT 0x4000000ULL
+#endif
+
+/**
+ * @brief Number of bytes committed each time a script allocator's pool grows.
+ * Rounded up to the allocation granularity.
+ */
+#ifndef DESCENT_SCRIPT_ALLOC_CHUNK
+#define DESCENT_SCRIPT_ALLOC_CHUNK 0x10000ULL
+#endif
+
+/**
+ * @brief Number of pooled size classes. Blocks up to 2048 bytes are pooled,
+ * larger blocks are mapped individually.
+ */
+#define SCRIPT_ALLOC_CLASS_COUNT 24u
+
+/**
+ * @struct ScriptAllocator
+ * @brief A capped Lua allocator.
+ *
+ * Small blocks are served from per-size-class free lists carved out of a
+ * single reservation, which is committed in chunks as it grows. Blocks larger
+ * than the largest size class are mapped individually with @ref sysalloc.
+ *
+ * The total memory committed by the allocator never exceeds its limit. Once
+ * the limit is reached, allocations fail and Lua raises a memory error in the
+ * script, which the caller can handle like any other script error.
+ *
+ * Pool memory is recycled within the allocator, but is not returned to the
+ * system until @ref script_allocator_release() is called.
+ *
+ * A script allocator is not thread-safe, just like the Lua state that uses it.
+ *
+ * Must be initialized with @ref script_allocator_init() before use.
+ */
+typedef struct {
+	Sysalloc _pool;
+	size_t   _limit;
+	size_t   _committed;
+	size_t   _top;
+	size_t   _footprint;
+	size_t   _used;
+	void    *_free[SCRIPT_ALLOC_CLASS_COUNT];
+} ScriptAllocator;
+
+/**
+ * @brief Initializes a script allocator.
+ *
+ * Reserves, but does not commit, address space for the allocator's pool.
+ *
+ * @param a Pointer to the allocator.
+ * @param limit The maximum number of bytes the allocator may commit. If 0,
+ * @ref DESCENT_SCRIPT_ALLOC_LIMIT is used.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p a is NULL.
+ * - Any error returned by @ref sysalloc_reserve.
+ */
+rcode script_allocator_init(ScriptAllocator *a, size_t limit);
+
+/**
+ * @brief Releases all memory held by a script allocator.
+ *
+ * Every Lua state using the allocator must be closed first.
+ *
+ * @param a Pointer to the allocator.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p a is NULL.
+ * - Any error returned by @ref sysfree.
+ */
+rcode script_allocator_release(ScriptAllocator *a);
+
+/**
+ * @brief The allocation function of a script allocator.
+ *
+ * Matches the signature of `lua_Alloc`. Pass it to @ref create_lua_sandbox()
+ * or @ref run_lua_script() with a pointer to an initialized
+ * @ref ScriptAllocator as the user data.
+ *
+ * Shrinking a block never fails, as Lua requires.
+ *
+ * @param ud Pointer to the script allocator.
+ * @param ptr The block to reallocate or free, or NULL to allocate.
+ * @param osize The size of @p ptr, or the type of the object being allocated
+ * if @p ptr is NULL.
+ * @param nsize The requested size, or 0 to free @p ptr.
+ * @return The new block, or NULL if it could not be allocated or was freed.
+ */
+void *script_allocator_lua(void *ud, void *ptr, size_t osize, size_t nsize);
+
+/**
+ * @brief Gets the number of bytes currently handed out to Lua, including
+ * size-class rounding.
+ * @param a Pointer to the allocator.
+ * @return The number of bytes in use, or 0 if @p a is NULL.
+ */
+size_t script_allocator_used(const ScriptAllocator *a);
+
+/**
+ * @brief Gets the number of bytes the allocator has committed. This is the
+ * value checked against the limit.
+ * @param a Pointer to the allocator.
+ * @return The number of bytes committed, or 0 if @p a is NULL.
+ */
+size_t script_allocator_footprint(const ScriptAllocator *a);
+
+#endif
@@ -22,23 +22,33 @@
  * @brief Threading and synchronization primitives.
  *
  * This module provides low-level threading and synchronization facilities,
- * including thread management, mutual exclusion, condition variables,
- * semaphores, and queue-based locks.
+ * including thread management and CPU affinity, mutual exclusion, condition
+ * variables, semaphores, queue-based locks, fibers, and a work-stealing job
+ * system with parallel loops built on it.
  *
  * All mechanisms in this module are intra-process only and are not safe for
  * use across process boundaries.
  */
 
 #include <descent/thread/atomic.h>
+#include <descent/thread/barrier.h>
 #include <descent/thread/call_once.h>
-// #include <descent/thread/barrier.h> // TODO: Unimplemented
+#include <descent/thread/channel.h>
 #include <descent/thread/condition.h>
+#include <descent/thread/epoch.h>
+#include <descent/thread/fiber.h>
 #include <descent/thread/futex.h>
+#include <descent/thread/job.h>
 #include <descent/thread/mutex.h>
+#include <descent/thread/parallel.h>
 #include <descent/thread/qutex.h>
-// #include <descent/thread/rwlock.h> // TODO: Unimplemented
+#include <descent/thread/queue.h>
+#include <descent/thread/rwlock.h>
 #include <descent/thread/semaphore.h>
+#include <descent/thread/seqlock.h>
 #include <descent/thread/thread.h>
 #include <descent/thread/tls.h>
+#include <descent/thread/topology.h>
+#include <descent/thread/wait.h>
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_BARRIER_H
+#define DESCENT_THREAD_BARRIER_H
+
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+
+/**
+ * @brief Static barrier initializer.
+ * @param count The number of participating threads. Must not be 0.
+ */
+#define BARRIER_INIT(count) BARRIER_INIT_COMPLETION(count, NULL, NULL)
+
+/**
+ * @brief Static barrier initializer with a completion function.
+ * @param count The number of participating threads. Must not be 0.
+ * @param f The function run by the last thread to arrive at each phase.
+ * @param a The argument passed to the completion function.
+ */
+#define BARRIER_INIT_COMPLETION(count, f, a) {._count = (count), ._arrived = ATOMIC_INIT(0), ._generation = ATOMIC_INIT(0), ._parked = ATOMIC_INIT(0), ._spin = ATOMIC_INIT(0), ._completion = (f), ._argument = (a)}
+
+/**
+ * @struct Barrier
+ * @brief A reusable barrier, at which a fixed number of threads wait for each
+ * other.
+ *
+ * Each phase ends once every participating thread has arrived. The last thread
+ * to arrive runs the completion function, if any, and then releases the
+ * others, so the completion function can act on the results of the phase
+ * before any thread starts the next. The barrier is ready for the next phase
+ * as soon as it releases.
+ *
+ * Threads spin briefly before parking, since phases of lockstep work tend to
+ * end close together. The number of spins is learned per barrier from how long
+ * past waits took.
+ *
+ * @note This mechanism is intra-process only and cannot be shared between processes.
+ */
+struct Barrier {
+	uint32_t  _count;
+	atomic_32 _arrived;
+	atomic_32 _generation;
+	atomic_32 _parked;
+	atomic_32 _spin;       // Learned spin budget
+	void    (*_completion)(void *argument);
+	void     *_argument;
+};
+
+/**
+ * @brief Initializes a barrier.
+ * @param b Pointer to the barrier. Must not have threads waiting on it.
+ * @param count The number of participating threads.
+ * @param completion The function run by the last thread to arrive at each
+ * phase. Can be NULL.
+ * @param argument The argument passed to @p completion.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p b is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p count is 0.
+ */
+rcode barrier_init(struct Barrier *b, unsigned int count, void (*completion)(void *), void *argument);
+
+/**
+ * @brief Waits until every participating thread has arrived at the barrier.
+ *
+ * The calling thread spins briefly, then blocks until the phase ends. Exactly
+ * as many threads as the barrier was initialized with must wait at each phase.
+ *
+ * @param b Pointer to the barrier.
+ * @return
+ * - 0: The phase ended.
+ * - @ref DESCENT_ERROR_NULL: @p b is NULL.
+ */
+rcode barrier_wait(struct Barrier *b);
+
+#endif
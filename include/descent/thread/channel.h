@@ -0,0 +1,132 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_CHANNEL_H
+#define DESCENT_THREAD_CHANNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+#include <descent/utilities/platform.h>
+
+/**
+ * @struct Channel
+ * @brief A bounded wait-free single-producer single-consumer channel of
+ * fixed-size messages.
+ *
+ * Intended for high-rate one-way command streams, such as from the main
+ * thread to a unique thread running rendering or audio. Each side keeps a
+ * cached copy of the other side's position on its own cache line, and only
+ * rereads the shared position when the cached one says the channel is full or
+ * empty. Pushes and pops copy whole batches and never loop, lock, or
+ * compare-and-swap.
+ *
+ * With the doorbell enabled, either side may sleep until the other makes
+ * progress. Without it, both sides must poll, but pushes and pops never touch
+ * the doorbell's cache line.
+ *
+ * Exactly one thread may push and one thread may pop at a time.
+ *
+ * Must be initialized with @ref channel_init() before use.
+ *
+ * @note This channel is intra-process only and cannot be shared between
+ * processes.
+ */
+struct Channel {
+	// Written by the producer
+	_Alignas(DESCENT_PLATFORM_CACHE_LINE) atomic_64 _tail;
+	uint64_t _head_cache;
+
+	// Written by the consumer
+	_Alignas(DESCENT_PLATFORM_CACHE_LINE) atomic_64 _head;
+	uint64_t _tail_cache;
+
+	// Read by both sides, and only written by channel_init()
+	_Alignas(DESCENT_PLATFORM_CACHE_LINE) unsigned char *_buffer;
+	size_t   _size;
+	uint64_t _mask;
+	bool     _doorbell;
+
+	// Written by either side when it sleeps or wakes the other
+	_Alignas(DESCENT_PLATFORM_CACHE_LINE) atomic_32 _bell;
+	atomic_32 _sleeping;
+	char      _pad[DESCENT_PLATFORM_CACHE_LINE - 2 * sizeof(atomic_32)];
+};
+
+/**
+ * @brief Initializes a channel over a caller-provided buffer.
+ *
+ * The channel must not be in use.
+ *
+ * @param c Pointer to the channel.
+ * @param buffer Storage for @p capacity messages, which must remain valid while
+ * the channel is used.
+ * @param size The size of a message in bytes.
+ * @param capacity The number of messages. Must be a power of two.
+ * @param doorbell Whether either side may sleep with @ref channel_wait or
+ * @ref channel_wait_space.
+ * @return
+ * - 0: Channel successfully initialized.
+ * - @ref DESCENT_ERROR_NULL: @p c or @p buffer is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p size is 0, or @p capacity is not a power of
+ *   two.
+ */
+rcode channel_init(struct Channel *c, void *buffer, size_t size, size_t capacity, bool doorbell);
+
+/**
+ * @brief Pushes as many of a batch of messages as fit. Producer only.
+ * @param c Pointer to the channel.
+ * @param messages Array of messages to copy into the channel.
+ * @param count The number of messages.
+ * @return The number of messages pushed, from the start of @p messages.
+ */
+size_t channel_push(struct Channel *c, const void *messages, size_t count);
+
+/**
+ * @brief Pops up to a batch of messages. Consumer only.
+ * @param c Pointer to the channel.
+ * @param messages Array which receives the messages.
+ * @param count The maximum number of messages to pop.
+ * @return The number of messages popped.
+ */
+size_t channel_pop(struct Channel *c, void *messages, size_t count);
+
+/**
+ * @brief Blocks until the channel holds at least one message. Consumer only.
+ * @param c Pointer to the channel.
+ * @return
+ * - 0: The channel holds a message.
+ * - @ref DESCENT_ERROR_NULL: @p c is NULL.
+ * - @ref DESCENT_ERROR_STATE: The channel has no doorbell.
+ * - Any error returned by @ref futex_wait.
+ */
+rcode channel_wait(struct Channel *c);
+
+/**
+ * @brief Blocks until the channel has space for at least one message.
+ * Producer only.
+ * @param c Pointer to the channel.
+ * @return
+ * - 0: The channel has space.
+ * - @ref DESCENT_ERROR_NULL: @p c is NULL.
+ * - @ref DESCENT_ERROR_STATE: The channel has no doorbell.
+ * - Any error returned by @ref futex_wait.
+ */
+rcode channel_wait_space(struct Channel *c);
+
+#endif
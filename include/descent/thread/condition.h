@@ -46,7 +46,7 @@
  * @ingroup condition Condition
  * @brief Condition variable initializer, equivalent to {0}.
  */
-#define CONDITION_INIT { ._generation = ATOMIC_INIT(0) }
+#define CONDITION_INIT { ._generation = ATOMIC_INIT(0), ._requeue = ATOMIC_INIT(0), ._any = ATOMIC_INIT(0), ._any_waiters = ATOMIC_INIT(0) }
 
 /**
  * @ingroup condition Condition
@@ -61,7 +61,10 @@
  * explicitly zeroed before use for dynamic instances.
  */
 struct Condition {
-	atomic_32 _generation;
+	atomic_32  _generation;
+	atomic_ptr _requeue;     // Futex of the lock waited with, or mixed
+	atomic_32  _any;         // Futex for wait_any(), which must not be requeued
+	atomic_32  _any_waiters;
 };
 
 /**
@@ -83,6 +86,11 @@ rcode condition_signal(struct Condition *c);
  * @brief Wakes all threads waiting on the condition variable.
  *
  * All threads currently waiting on the condition variable will be woken.
+ * Where the platform supports it, and every waiter so far has used the same
+ * lock, only one thread is woken immediately, and the rest are moved to wait
+ * on that lock. Each is then woken as the previous one releases the lock,
+ * instead of all of them contending for it at once. Threads waiting with @ref wait_any hold no lock, and are
+ * always woken directly.
  *
  * @param c Pointer to the condition variable.
  * @return
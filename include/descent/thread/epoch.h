@@ -0,0 +1,131 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_EPOCH_H
+#define DESCENT_THREAD_EPOCH_H
+
+#include <descent/rcode.h>
+
+/**
+ * @brief The number of objects a thread retires between attempts to advance
+ * the epoch.
+ */
+#ifndef DESCENT_EPOCH_RETIRE_THRESHOLD
+#define DESCENT_EPOCH_RETIRE_THRESHOLD 64u
+#endif
+
+/**
+ * @brief Static epoch node initializer, equivalent to {0}.
+ */
+#define EPOCH_NODE_INIT {._next = NULL, ._reclaim = NULL}
+
+/**
+ * @struct EpochNode
+ * @brief Intrusive link by which a retired object waits to be reclaimed.
+ *
+ * Epoch-based reclamation lets lock-free structures unlink objects which
+ * other threads may still be reading, and free them later once no thread can
+ * hold a reference. Threads read shared objects only between
+ * @ref epoch_enter and @ref epoch_exit. An unlinked object is passed to
+ * @ref epoch_retire, and its reclaim function is called once every managed
+ * thread has been outside of such a region, or has entered a new one, since
+ * it was retired.
+ *
+ * The global epoch only advances once every thread inside a region has
+ * observed it, so a thread which stays inside a region delays reclamation for
+ * every thread. Regions should be kept short.
+ *
+ * Retired objects are kept on the retiring thread, and reclaimed by it during
+ * later calls to @ref epoch_retire and @ref epoch_exit. Each time
+ * @ref DESCENT_EPOCH_RETIRE_THRESHOLD more objects are pending, the retiring
+ * thread tries to advance the epoch, and leaves it to a background job if a
+ * thread within a region holds it back.
+ */
+struct EpochNode {
+	struct EpochNode *_next;
+	void (*_reclaim)(struct EpochNode *node);
+};
+
+/**
+ * @brief Enters a critical region, within which shared objects retired by
+ * other threads are not reclaimed.
+ *
+ * Regions may be nested, and end with the matching outermost
+ * @ref epoch_exit.
+ *
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref DESCENT_ERROR_OVERFLOW: The region is nested too deeply.
+ * @warning A job must not wait on a job counter within a region, since it may
+ * resume on another thread.
+ */
+rcode epoch_enter(void);
+
+/**
+ * @brief Exits a critical region, and reclaims the calling thread's retired
+ * objects which have become safe to reclaim.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref DESCENT_ERROR_STATE: The calling thread is not within a region.
+ */
+rcode epoch_exit(void);
+
+/**
+ * @brief Retires an object which has been unlinked from a shared structure,
+ * to be reclaimed once no thread can still hold a reference to it.
+ *
+ * May be called within or outside of a region. The reclaim function is called
+ * on the calling thread.
+ *
+ * @param node The object's epoch node, which must remain valid until it is
+ * reclaimed.
+ * @param reclaim The function which frees the object.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p node or @p reclaim is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ */
+rcode epoch_retire(struct EpochNode *node, void (*reclaim)(struct EpochNode *node));
+
+/**
+ * @brief Attempts to advance the global epoch, without blocking.
+ *
+ * This is normally driven by a background job, and need not be called
+ * directly.
+ *
+ * @return
+ * - 0: The epoch advanced.
+ * - @ref THREAD_INFO_BUSY: A thread within a region has not yet observed the
+ *   current epoch.
+ */
+rcode epoch_advance(void);
+
+/**
+ * @brief Waits until every object retired by the calling thread has been
+ * reclaimed.
+ *
+ * Intended for shutdown, or before a thread stops using epochs, since objects
+ * retired by a thread are otherwise only reclaimed by that thread.
+ *
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref THREAD_ERROR_DEADLOCK: The calling thread is within a region.
+ */
+rcode epoch_synchronize(void);
+
+#endif
@@ -0,0 +1,104 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_FIBER_H
+#define DESCENT_THREAD_FIBER_H
+
+#include <stddef.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+
+/**
+ * @brief The default stack size of a fiber, in bytes, excluding its guard page.
+ */
+#ifndef DESCENT_FIBER_STACK_SIZE
+#define DESCENT_FIBER_STACK_SIZE 0x40000u
+#endif
+
+/**
+ * @brief Static initializer for a fiber which captures the calling thread's
+ * own context, equivalent to {0}.
+ */
+#define FIBER_INIT {._context = NULL, ._stack = {0}, ._function = NULL, ._argument = NULL}
+
+/**
+ * @struct Fiber
+ * @brief A user-mode execution context with its own stack.
+ *
+ * Switching between fibers saves and restores only the callee-saved registers,
+ * so a switch costs about as much as a function call. Fibers are not bound to
+ * a thread, and a suspended fiber may be resumed on any thread.
+ *
+ * Stacks are allocated with @ref sysalloc_reserve, with the lowest page left
+ * uncommitted as a guard against overflow. On Windows, the native fiber API is
+ * used instead, and it allocates its own stacks.
+ *
+ * A zero-initialized fiber does not own a stack. When it is switched away from,
+ * it captures the context of the calling thread, which can then be resumed by
+ * switching back to it.
+ *
+ * @note Fibers are supported on x86-64 and AArch64. On other architectures,
+ * @ref fiber_create returns @ref DESCENT_ERROR_UNSUPPORTED.
+ */
+struct Fiber {
+	void     *_context;
+	Sysalloc  _stack;
+	void    (*_function)(void *argument);
+	void     *_argument;
+};
+
+/**
+ * @brief Creates a fiber.
+ *
+ * The fiber starts running @p function the first time it is switched to. The
+ * function must never return; it must switch to another fiber instead.
+ *
+ * @param f Pointer to the fiber.
+ * @param stack_size The size of the fiber's stack in bytes, or 0 for
+ * @ref DESCENT_FIBER_STACK_SIZE. Rounded up to the allocation granularity.
+ * @param function The function run by the fiber. Must not be NULL.
+ * @param argument The argument passed to @p function.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p f or @p function is NULL.
+ * - @ref DESCENT_ERROR_UNSUPPORTED if fibers are unsupported on this platform.
+ * - @ref DESCENT_ERROR_MEMORY if the stack could not be allocated.
+ * - Any error returned by @ref sysalloc_reserve or @ref sysalloc_commit.
+ */
+rcode fiber_create(struct Fiber *f, size_t stack_size, void (*function)(void *), void *argument);
+
+/**
+ * @brief Destroys a fiber and releases its stack.
+ * @param f Pointer to the fiber. Must not be running.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p f is NULL.
+ * - Any error returned by @ref sysfree.
+ */
+rcode fiber_destroy(struct Fiber *f);
+
+/**
+ * @brief Suspends the calling fiber and resumes another.
+ *
+ * Returns when another thread or fiber switches back to @p from.
+ *
+ * @param from The fiber which is currently running, which receives the saved
+ * context.
+ * @param to The fiber to resume.
+ */
+void fiber_switch(struct Fiber *from, struct Fiber *to);
+
+#endif
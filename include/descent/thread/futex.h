@@ -19,6 +19,20 @@
 #include <descent/thread/atomic.h>
 #include <descent/rcode.h>
 
+/**
+ * @brief The maximum number of futexes @ref futex_wait_any can wait on.
+ */
+#define FUTEX_WAIT_ANY_MAX 128u
+
+/**
+ * @struct FutexWaiter
+ * @brief One futex of a multi-wait, and the value it is expected to hold.
+ */
+struct FutexWaiter {
+	atomic_32 *futex;
+	uint32_t   expected;
+};
+
 /**
  * @brief Waits on a futex until its value changes.
  *
@@ -69,6 +83,58 @@ rcode futex_wait(atomic_32 *futex, uint32_t expected);
  */
 rcode futex_timedwait(atomic_32 *futex, uint32_t expected, uint64_t nanoseconds);
 
+/**
+ * @brief Waits on several futexes until any of their values change.
+ *
+ * This function atomically compares the current value of each futex with its
+ * expected value. If all are equal, the calling thread may be suspended until
+ * another thread wakes any of the futexes. If any value differs, the function
+ * returns immediately without sleeping.
+ *
+ * On Linux 5.16 and later this uses futex_waitv. Elsewhere, the thread waits
+ * on a global event count which every wake advances while any thread is in a
+ * multi-wait, so unrelated wakes cause spurious wakeups.
+ *
+ * The caller must always recheck the futex values after this function
+ * returns, as spurious wakeups are possible.
+ *
+ * @param waiters The futexes to wait on, and their expected values.
+ * @param count The number of futexes. Must not be 0 or greater than
+ * @ref FUTEX_WAIT_ANY_MAX.
+ * @return
+ * - 0: Success or spurious wakeup.
+ * - @ref DESCENT_ERROR_NULL: @p waiters or one of its futexes is a null
+ *   pointer.
+ * - @ref DESCENT_ERROR_INVALID: @p count is out of range, or invalid futex
+ *   addresses or parameters.
+ * - @ref DESCENT_ERROR_FORBIDDEN: A futex cannot be accessed.
+ * - @ref DESCENT_ERROR_OS: Other OS-level errors.
+ */
+rcode futex_wait_any(const struct FutexWaiter *waiters, unsigned int count);
+
+/**
+ * @brief Waits on several futexes until any of their values change or a
+ * timeout expires.
+ *
+ * Behaves as @ref futex_wait_any, but gives up once the timeout expires.
+ * Timeouts are capped at the value returned by @ref time_max_timeout().
+ *
+ * @param waiters The futexes to wait on, and their expected values.
+ * @param count The number of futexes. Must not be 0 or greater than
+ * @ref FUTEX_WAIT_ANY_MAX.
+ * @param nanoseconds The maximum number of nanoseconds to wait.
+ * @return
+ * - 0: Success or spurious wakeup.
+ * - @ref THREAD_INFO_TIMEOUT: The wait timed out.
+ * - @ref DESCENT_ERROR_NULL: @p waiters or one of its futexes is a null
+ *   pointer.
+ * - @ref DESCENT_ERROR_INVALID: @p count is out of range, or invalid futex
+ *   addresses or parameters.
+ * - @ref DESCENT_ERROR_FORBIDDEN: A futex cannot be accessed.
+ * - @ref DESCENT_ERROR_OS: Other OS-level errors.
+ */
+rcode futex_timedwait_any(const struct FutexWaiter *waiters, unsigned int count, uint64_t nanoseconds);
+
 /**
  * @brief Wakes one or more threads waiting on a futex.
  *
@@ -142,4 +208,33 @@ rcode futex_wake_next(atomic_32 *futex);
  */
 rcode futex_wake_all(atomic_32 *futex);
 
+/**
+ * @brief Wakes threads waiting on a futex, and moves the rest to wait on
+ * another futex.
+ *
+ * Up to @p wake threads waiting on @p futex are woken, and all others are
+ * requeued to wait on @p target, as if they had called @ref futex_wait on it.
+ * This lets a condition variable wake one waiter and hand the rest to the
+ * mutex, so that they are woken one at a time as it is released, instead of
+ * all at once.
+ *
+ * The operation is only performed if @p futex still holds @p expected.
+ *
+ * @param futex Pointer to a 32-bit atomic futex variable.
+ * @param expected The value expected to be stored in @p futex.
+ * @param wake Maximum number of waiting threads to wake.
+ * @param target Pointer to the futex to move the remaining waiters to.
+ * @return
+ * - 0: Successfully woke and requeued zero or more threads.
+ * - @ref THREAD_INFO_BUSY: The value of @p futex differs from @p expected,
+ *   and no thread was woken.
+ * - @ref DESCENT_ERROR_NULL: @p futex or @p target is a null pointer.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The futex cannot be accessed.
+ * - @ref DESCENT_ERROR_INVALID: Invalid futex address or parameters.
+ * - @ref DESCENT_ERROR_OS: Other OS-level errors.
+ * @note Where the platform cannot requeue waiters, all threads waiting on
+ * @p futex are woken instead.
+ */
+rcode futex_requeue(atomic_32 *futex, uint32_t expected, uint32_t wake, atomic_32 *target);
+
 #endif
@@ -0,0 +1,319 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_JOB_H
+#define DESCENT_THREAD_JOB_H
+
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+
+/**
+ * @brief The capacity of each thread's job queue. Must be a power of two.
+ *
+ * Jobs submitted to a full queue are run immediately by the submitting thread.
+ */
+#ifndef DESCENT_JOB_QUEUE_SIZE
+#define DESCENT_JOB_QUEUE_SIZE 4096u
+#endif
+
+/**
+ * @brief Set to 0 to run jobs directly on the worker threads' stacks instead of
+ * on fibers.
+ *
+ * With fibers, a job which waits on a counter suspends its fiber, and the
+ * worker continues with other work on a fresh fiber. Without them, the waiting
+ * job runs other jobs nested on its own stack until the counter finishes.
+ */
+#ifndef DESCENT_JOB_FIBERS
+#define DESCENT_JOB_FIBERS 1
+#endif
+
+/**
+ * @brief The number of fibers shared by all workers, which bounds the number of
+ * jobs suspended at once. Waits beyond this fall back to running jobs nested.
+ */
+#ifndef DESCENT_JOB_FIBER_COUNT
+#define DESCENT_JOB_FIBER_COUNT 256u
+#endif
+
+/**
+ * @brief The stack size of each job fiber, in bytes.
+ *
+ * Pages are only backed by memory once touched, but jobs run nested by a wait
+ * without a free fiber share the waiting fiber's stack.
+ */
+#ifndef DESCENT_JOB_FIBER_STACK_SIZE
+#define DESCENT_JOB_FIBER_STACK_SIZE 0x100000u
+#endif
+
+/**
+ * @brief The percentage of worker threads which may run background jobs at
+ * once. At least one worker always may.
+ */
+#ifndef DESCENT_JOB_BACKGROUND_SHARE
+#define DESCENT_JOB_BACKGROUND_SHARE 50u
+#endif
+
+/**
+ * @enum JobPriority
+ * @brief Job priority classes, each of which is queued in its own lane.
+ *
+ * Threads always take jobs from higher priority lanes first. A running job is
+ * never preempted, so background jobs are limited to a share of the workers,
+ * leaving the rest free for frame work.
+ */
+typedef enum {
+	JOB_PRIORITY_CRITICAL,   /**< Work the current frame is waiting on */
+	JOB_PRIORITY_NORMAL,     /**< Default priority */
+	JOB_PRIORITY_BACKGROUND, /**< Work which may span frames, such as asset decoding, compression, and cache writes */
+	JOB_PRIORITY_COUNT
+} JobPriority;
+
+/**
+ * @brief Static job counter initializer, equivalent to {0}.
+ */
+#define JOB_COUNTER_INIT {._count = ATOMIC_INIT(0), ._pending = ATOMIC_INIT(0)}
+
+/**
+ * @brief Static job initializer, with @ref JOB_PRIORITY_NORMAL.
+ * @param f The job function.
+ * @param a The argument passed to the job function.
+ */
+#define JOB_INIT(f, a) JOB_INIT_PRIORITY(f, a, JOB_PRIORITY_NORMAL)
+
+/**
+ * @brief Static job initializer with a priority.
+ * @param f The job function.
+ * @param a The argument passed to the job function.
+ * @param p The @ref JobPriority of the job.
+ */
+#define JOB_INIT_PRIORITY(f, a, p) {.function = (f), .argument = (a), .priority = (p), ._counter = NULL, ._next = NULL}
+
+/**
+ * @struct JobCounter
+ * @brief Counts the unfinished jobs of one or more submissions.
+ *
+ * A counter is incremented when jobs are submitted against it and decremented
+ * as each job finishes. Waiting on a counter runs other jobs until it reaches
+ * zero. Jobs may also be held back until a counter reaches zero, which chains
+ * batches of work into a dependency graph.
+ *
+ * A counter may be reused once it has reached zero.
+ */
+struct JobCounter {
+	atomic_32  _count;
+	atomic_ptr _pending; // Jobs released when the count reaches zero
+};
+
+/**
+ * @struct Job
+ * @brief A function to be run on a worker thread.
+ *
+ * Jobs are owned by the caller, and must remain valid until the counter they
+ * were submitted with reaches zero.
+ */
+struct Job {
+	void (*function)(void *argument);
+	void *argument;
+	JobPriority priority;
+	struct JobCounter *_counter;
+	struct Job *_next;
+};
+
+/**
+ * @brief Starts the job system on a batch of worker threads.
+ *
+ * The job system takes ownership of the worker threads, which park on a futex
+ * while there is no work. Each managed thread has its own job queue, and idle
+ * workers steal from the queues of other threads.
+ *
+ * @param count The number of worker threads. Must not be 0 or greater than
+ * thread_worker_max().
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_INVALID if @p count is 0.
+ * - @ref DESCENT_ERROR_STATE if the job system is already running.
+ * - Any error returned by @ref thread_spawn_worker.
+ * @note This function should only be called from the main thread. Calling it from
+ * any other thread will return DESCENT_ERROR_FORBIDDEN.
+ */
+rcode job_start(unsigned int count);
+
+/**
+ * @brief Starts the job system with one worker thread per physical core.
+ *
+ * Each worker is pinned to the SMT siblings of one core, and workers are
+ * placed cache domain by cache domain, as by @ref topology_core_affinity. Idle
+ * workers steal from workers sharing their last-level cache before any other
+ * thread. Machines with more cores than thread_worker_max() only use that many.
+ *
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_STATE if the job system is already running.
+ * - Any error returned by @ref topology_query or @ref thread_spawn_worker.
+ * @note This function should only be called from the main thread. Calling it from
+ * any other thread will return DESCENT_ERROR_FORBIDDEN.
+ */
+rcode job_start_per_core(void);
+
+/**
+ * @brief Stops the job system and collects its worker threads.
+ *
+ * Jobs which are still queued are run before the workers exit.
+ *
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_STATE if the job system is not running.
+ * - Any error returned by @ref thread_collect_worker.
+ * @note This function should only be called from the main thread. Calling it from
+ * any other thread will return DESCENT_ERROR_FORBIDDEN.
+ */
+rcode job_stop(void);
+
+/**
+ * @brief Gets the number of worker threads running the job system.
+ * @return The number of active worker threads, or 0 if the job system is not
+ * running.
+ */
+unsigned int job_worker_count(void);
+
+/**
+ * @brief Grows or shrinks the number of worker threads running the job system.
+ *
+ * The job system keeps every worker thread it has spawned until it stops.
+ * Shrinking the count parks the workers above it on a futex once they finish
+ * their current job, and work queued on their threads is stolen by the rest.
+ * Growing the count wakes parked workers first, and only spawns threads beyond
+ * the largest count used so far. This sheds cores while the application is
+ * paused or in the background, and takes them back without the cost of
+ * creating threads.
+ *
+ * Workers added beyond those started by @ref job_start_per_core are not
+ * pinned. The background limit is reset from
+ * @ref DESCENT_JOB_BACKGROUND_SHARE of the new count.
+ *
+ * @param count The number of active worker threads. Must not be 0 or greater
+ * than thread_worker_max().
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_INVALID if @p count is 0 or too large.
+ * - @ref DESCENT_ERROR_STATE if the job system is not running.
+ * - Any error returned by @ref thread_spawn_worker, in which case the count is
+ *   unchanged.
+ * @note This function should only be called from the main thread. Calling it from
+ * any other thread will return DESCENT_ERROR_FORBIDDEN.
+ */
+rcode job_set_worker_count(unsigned int count);
+
+/**
+ * @brief Sets the number of worker threads which may run background jobs at
+ * once.
+ *
+ * The limit is reset from @ref DESCENT_JOB_BACKGROUND_SHARE by @ref job_start
+ * and @ref job_set_worker_count.
+ * Lowering it does not interrupt background jobs which are already running.
+ *
+ * @param count The number of worker threads. Must not be 0.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_INVALID if @p count is 0.
+ * - @ref DESCENT_ERROR_STATE if the job system is not running.
+ */
+rcode job_set_background_limit(unsigned int count);
+
+/**
+ * @brief Submits jobs to the job system.
+ *
+ * The jobs are pushed onto the calling thread's queue for their priority, from
+ * which they are stolen by idle workers.
+ *
+ * @param jobs Array of jobs to run.
+ * @param count The number of jobs.
+ * @param counter Counter to increment by @p count, and decrement as each job
+ * finishes. Can be NULL.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p jobs is NULL or a job has no function.
+ * - @ref DESCENT_ERROR_INVALID if a job's priority is invalid.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ * - @ref DESCENT_ERROR_STATE if the job system is not running.
+ */
+rcode job_submit(struct Job *jobs, unsigned int count, struct JobCounter *counter);
+
+/**
+ * @brief Submits jobs to be run once a dependency counter reaches zero.
+ *
+ * The jobs are held by @p dependency and pushed onto the queue of the thread
+ * which finishes its last job. If @p dependency is already zero, the jobs are
+ * submitted immediately.
+ *
+ * @param dependency Counter the jobs wait on.
+ * @param jobs Array of jobs to run.
+ * @param count The number of jobs.
+ * @param counter Counter to increment by @p count immediately, and decrement
+ * as each job finishes. Can be NULL. Must not be @p dependency.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p dependency or @p jobs is NULL or a job has no
+ *   function.
+ * - @ref DESCENT_ERROR_INVALID if @p counter is @p dependency, or a job's
+ *   priority is invalid.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ * - @ref DESCENT_ERROR_STATE if the job system is not running.
+ */
+rcode job_submit_after(struct JobCounter *dependency, struct Job *jobs, unsigned int count, struct JobCounter *counter);
+
+/**
+ * @brief Waits until a job counter reaches zero.
+ *
+ * Within a job on a worker, the job's fiber is suspended and the worker moves
+ * on to other work. The job resumes, possibly on another worker, once the
+ * counter finishes.
+ *
+ * Elsewhere, or when fibers are unavailable, the calling thread runs queued
+ * jobs rather than blocking, first from its own queue and then stolen from
+ * other threads. It only sleeps once no work can be found. Only worker threads
+ * run background jobs while waiting.
+ *
+ * A background job does not count against the background limit while it
+ * waits.
+ *
+ * @param counter Pointer to the counter.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p counter is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ * @warning Anything tied to the calling thread rather than the job, such as a
+ * held @ref Mutex or @ref RWLock, an epoch region, or thread-local storage,
+ * must not be held across this call. The job may resume on another thread, and
+ * other jobs run on this one meanwhile. The stack allocator from
+ * @ref stackalloc_self() belongs to the job's fiber, and is safe to keep.
+ */
+rcode job_wait(struct JobCounter *counter);
+
+/**
+ * @brief Gets the priority of the job the calling thread is running.
+ *
+ * Jobs which split their work should submit the pieces with this priority, so
+ * that background work does not crowd out frame work by spawning normal jobs.
+ *
+ * @return The priority of the running job, or @ref JOB_PRIORITY_NORMAL outside
+ * of a job.
+ */
+JobPriority job_priority(void);
+
+#endif
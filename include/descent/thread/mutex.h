@@ -21,10 +21,18 @@
 #include <descent/thread/atomic_types.h>
 #include <descent/thread/condition.h>
 
+/**
+ * @brief The time in nanoseconds a mutex may stay contended before it is
+ * handed directly to a waiting thread.
+ */
+#ifndef DESCENT_MUTEX_FAIR_INTERVAL
+#define DESCENT_MUTEX_FAIR_INTERVAL 1000000u
+#endif
+
 /**
  * @brief Static mutex initializer, equivalent to {0}.
  */
-#define MUTEX_INIT {._owner = ATOMIC_INIT(0), ._state = ATOMIC_INIT(0)}
+#define MUTEX_INIT {._owner = ATOMIC_INIT(0), ._state = ATOMIC_INIT(0), ._spin = ATOMIC_INIT(0), ._waiters = ATOMIC_INIT(0), ._contended_since = 0}
 
 /**
  * @struct Mutex
@@ -32,13 +40,29 @@
  *
  * Ensures that only one thread can hold the lock at a time. Recursive locking is
  * not allowed; attempts to re-lock from the owning thread return a deadlock error.
+ *
+ * A contended lock spins briefly before parking the thread, so that short
+ * critical sections are waited out without system calls. The number of spins
+ * is learned per mutex from how long past acquisitions took.
+ *
+ * Unlocking does not normally favor waiting threads, so the releasing thread
+ * may immediately lock the mutex again. To bound how long a waiter can be
+ * starved, once a mutex has been contended for
+ * @ref DESCENT_MUTEX_FAIR_INTERVAL, the next unlock hands it directly to a
+ * waiting thread.
  * 
  * @warning Closing a thread while it owns a mutex leaves the mutex in an undefined state.
+ * @warning A mutex is owned by a thread, not a job. A job must not wait on a
+ * job counter while it holds a mutex, since it may resume on another thread,
+ * which cannot unlock it, while other jobs on its thread see it as their own.
  * @note This mechanism is intra-process only and cannot be shared between processes.
  */
 struct Mutex {
 	atomic_64 _owner;
 	atomic_32 _state;
+	atomic_32 _spin;            // Learned spin budget
+	atomic_32 _waiters;
+	uint64_t  _contended_since; // Owner only
 };
 
 /**
@@ -118,10 +142,33 @@ rcode mutex_unlock(struct Mutex *m);
  * - 0: Successfully waited and re-acquired the mutex.
  * - @ref DESCENT_ERROR_NULL: Either @p m or @p c is NULL.
  * - @ref DESCENT_ERROR_FORBIDDEN: Calling thread is invalid.
- * - Other mutex errors: Any error returned by @ref mutex_unlock or
- *   @ref mutex_lock.
+ * - Other mutex errors: Any error returned by @ref mutex_unlock.
  * @note Spurious wakeups are possible; always check the associated predicate.
  */
 rcode mutex_wait(struct Mutex *m, struct Condition *c);
 
+/**
+ * @brief Waits on a condition variable while holding the mutex, up to the
+ * specified timeout.
+ *
+ * The calling thread must hold the mutex before calling this function.
+ * The mutex is released while waiting and re-acquired before returning, even
+ * if the wait timed out.
+ *
+ * Timeouts are capped at the value returned by @ref time_max_timeout().
+ *
+ * @param m Pointer to the mutex currently held.
+ * @param c Pointer to the condition variable to wait on.
+ * @param nanoseconds The maximum number of nanoseconds to wait.
+ * @return
+ * - 0: Successfully waited and re-acquired the mutex.
+ * - @ref THREAD_INFO_TIMEOUT: The condition was not signaled within the
+ *   timeout. The mutex has been re-acquired.
+ * - @ref DESCENT_ERROR_NULL: Either @p m or @p c is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: Calling thread is invalid.
+ * - Other mutex errors: Any error returned by @ref mutex_unlock.
+ * @note Spurious wakeups are possible; always check the associated predicate.
+ */
+rcode mutex_timedwait(struct Mutex *m, struct Condition *c, uint64_t nanoseconds);
+
 #endif
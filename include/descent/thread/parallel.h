@@ -0,0 +1,93 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_PARALLEL_H
+#define DESCENT_THREAD_PARALLEL_H
+
+#include <stddef.h>
+
+#include <descent/rcode.h>
+
+/**
+ * @brief The maximum size of a @ref parallel_reduce value, in bytes.
+ *
+ * Partial values are kept on the stack, one per level of the reduction tree.
+ */
+#ifndef DESCENT_PARALLEL_VALUE_SIZE_MAX
+#define DESCENT_PARALLEL_VALUE_SIZE_MAX 64u
+#endif
+
+/**
+ * @brief Runs a function over a range of indices on the job system.
+ *
+ * The range is split lazily: each job processes its range one grain at a time,
+ * and only splits off the upper half of what remains while its queue is empty,
+ * meaning that other threads have taken all the work it offered. Ranges are
+ * therefore only divided as finely as there are threads to take them. Split
+ * ranges run at the priority of the calling job, from @ref job_priority.
+ *
+ * Returns once the function has been called for every index. If the job
+ * system is not running, the whole range is processed by the calling thread.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The number of indices processed between checks for idle
+ * threads, and the smallest range split off. 0 picks a grain from the range
+ * size and worker count.
+ * @param function The function called with each subrange [begin, end).
+ * @param context The context passed to @p function.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p function is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ */
+rcode parallel_for(size_t begin, size_t end, size_t grain, void (*function)(size_t begin, size_t end, void *context), void *context);
+
+/**
+ * @brief Reduces a range of indices to a single value on the job system.
+ *
+ * The range is halved recursively into leaves of at most @p grain indices. Each
+ * leaf starts from @p identity and is passed to @p map, and the value of each
+ * right sibling is merged into that of its left sibling with @p combine. Only the
+ * choice of which subtrees run on other threads depends on scheduling, so the
+ * result is the same on every run, even for operations such as floating-point
+ * addition which are not exactly associative. Subtrees run on other threads at
+ * the priority of the calling job, from @ref job_priority.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The maximum number of indices in a leaf. Must not be 0. Since it
+ * decides the shape of the tree, the result may differ between grains.
+ * @param size The size of a value in bytes. Must not be 0 or greater than
+ * @ref DESCENT_PARALLEL_VALUE_SIZE_MAX.
+ * @param identity The value each leaf starts from.
+ * @param map The function which accumulates a subrange [begin, end) into a
+ * value.
+ * @param combine The function which accumulates @p other into @p value, where
+ * @p other covers the indices directly after those of @p value.
+ * @param result Receives the reduced value. For an empty range, this is
+ * @p identity.
+ * @param context The context passed to @p map and @p combine.
+ * @return
+ * - 0 on success.
+ * - @ref DESCENT_ERROR_NULL if @p identity, @p map, @p combine or @p result is
+ *   NULL.
+ * - @ref DESCENT_ERROR_INVALID if @p grain or @p size is 0, or @p size is
+ *   greater than @ref DESCENT_PARALLEL_VALUE_SIZE_MAX.
+ * - @ref DESCENT_ERROR_FORBIDDEN if the calling thread is not managed.
+ */
+rcode parallel_reduce(size_t begin, size_t end, size_t grain, size_t size, const void *identity, void (*map)(size_t begin, size_t end, void *value, void *context), void (*combine)(void *value, const void *other, void *context), void *result, void *context);
+
+#endif
@@ -0,0 +1,136 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_QUEUE_H
+#define DESCENT_THREAD_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+#include <descent/utilities/platform.h>
+
+/**
+ * @struct QueueCell
+ * @brief A slot of a @ref Queue. Storage for cells is provided by the caller.
+ */
+struct QueueCell {
+	atomic_64 _sequence;
+	void     *_value;
+};
+
+/**
+ * @struct Queue
+ * @brief A bounded lock-free multi-producer multi-consumer queue of pointers.
+ *
+ * Each cell carries a sequence number which tells producers and consumers
+ * whether it is free or filled for the current lap of the ring, so a push or
+ * pop claims its position with a single compare-and-swap and never waits on
+ * another thread's push or pop to complete.
+ *
+ * The push and pop positions are kept on separate cache lines. The blocking
+ * variants park on a futex only once the queue is full or empty, and a push or
+ * pop only makes a system call when a thread is parked.
+ *
+ * Must be initialized with @ref queue_init() before use.
+ *
+ * @note This queue is intra-process only and cannot be shared between
+ * processes.
+ */
+struct Queue {
+	atomic_64         _push;
+	char              _pad0[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+	atomic_64         _pop;
+	char              _pad1[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+	atomic_32         _pushed;       // Bumped for parked consumers
+	atomic_32         _popped;       // Bumped for parked producers
+	atomic_32         _pop_waiters;
+	atomic_32         _push_waiters;
+	struct QueueCell *_cells;
+	uint64_t          _mask;
+};
+
+/**
+ * @brief Initializes a queue over caller-provided cells.
+ *
+ * The queue must not be in use.
+ *
+ * @param q Pointer to the queue.
+ * @param cells Array of cells, which must remain valid while the queue is used.
+ * @param capacity The number of cells. Must be a power of two of at least 2.
+ * @return
+ * - 0: Queue successfully initialized.
+ * - @ref DESCENT_ERROR_NULL: @p q or @p cells is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p capacity is not a power of two of at least 2.
+ */
+rcode queue_init(struct Queue *q, struct QueueCell *cells, size_t capacity);
+
+/**
+ * @brief Pushes a value, blocking while the queue is full.
+ * @param q Pointer to the queue.
+ * @param value The value to push.
+ * @return
+ * - 0: Value successfully pushed.
+ * - @ref DESCENT_ERROR_NULL: @p q is NULL.
+ * - Any error returned by @ref futex_wait.
+ */
+rcode queue_push(struct Queue *q, void *value);
+
+/**
+ * @brief Attempts to push a value without blocking.
+ * @param q Pointer to the queue.
+ * @param value The value to push.
+ * @return
+ * - 0: Value successfully pushed.
+ * - @ref THREAD_INFO_BUSY: The queue is full.
+ * - @ref DESCENT_ERROR_NULL: @p q is NULL.
+ */
+rcode queue_trypush(struct Queue *q, void *value);
+
+/**
+ * @brief Pops a value, blocking while the queue is empty.
+ * @param q Pointer to the queue.
+ * @param value Receives the popped value.
+ * @return
+ * - 0: Value successfully popped.
+ * - @ref DESCENT_ERROR_NULL: @p q or @p value is NULL.
+ * - Any error returned by @ref futex_wait.
+ */
+rcode queue_pop(struct Queue *q, void **value);
+
+/**
+ * @brief Attempts to pop a value without blocking.
+ * @param q Pointer to the queue.
+ * @param value Receives the popped value.
+ * @return
+ * - 0: Value successfully popped.
+ * - @ref THREAD_INFO_BUSY: The queue is empty.
+ * - @ref DESCENT_ERROR_NULL: @p q or @p value is NULL.
+ */
+rcode queue_trypop(struct Queue *q, void **value);
+
+/**
+ * @brief Gets the approximate number of values in a queue.
+ *
+ * The count may be stale by the time it is returned if other threads are
+ * pushing or popping.
+ *
+ * @param q Pointer to the queue.
+ * @return The number of values, or 0 if @p q is NULL.
+ */
+size_t queue_count(struct Queue *q);
+
+#endif
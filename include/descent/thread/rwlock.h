@@ -0,0 +1,187 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_RWLOCK_H
+#define DESCENT_THREAD_RWLOCK_H
+
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+#include <descent/utilities/platform.h>
+
+/**
+ * @brief The number of 64-bit words in an unsharded lock's reader set, which
+ * must hold a bit for every managed thread.
+ */
+#ifndef DESCENT_RWLOCK_READER_WORDS
+#define DESCENT_RWLOCK_READER_WORDS 4u
+#endif
+
+/**
+ * @brief Static reader-writer lock initializer, equivalent to {0}.
+ */
+#define RWLOCK_INIT {._state = ATOMIC_INIT(0), ._pending = ATOMIC_INIT(0), ._drain = ATOMIC_INIT(0), ._readers = {ATOMIC_INIT(0)}, ._writer = ATOMIC_INIT(0), ._shards = NULL, ._shard_count = 0}
+
+/**
+ * @struct RWLockShard
+ * @brief One cache line of a big-reader lock's reader set.
+ */
+struct RWLockShard {
+	atomic_64 _readers;
+	char      _pad[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+};
+
+/**
+ * @struct RWLock
+ * @brief A non-recursive reader-writer lock which prefers writers.
+ *
+ * Any number of threads may hold the lock for reading, or one thread for
+ * writing. Once a writer is waiting, new readers wait behind it, so a steady
+ * stream of readers cannot starve writers. A writer can downgrade its lock to a
+ * read lock without letting another writer in between.
+ *
+ * Each reader records itself in a set of reader threads. By default the set is
+ * held in a few words within the lock, which every reader writes. A lock
+ * initialized with @ref rwlock_init_sharded instead spreads the set across
+ * cache lines, so that readers on different cores do not contend, at the cost
+ * of writers scanning every shard.
+ *
+ * Recursive locking is not supported; attempting to lock a lock already held
+ * by the calling thread, in either mode, returns a deadlock error.
+ *
+ * @warning A lock is held by a thread, not a job. A job must not wait on a job
+ * counter while it holds a lock, since it may resume on another thread, which
+ * cannot unlock it, while other jobs on its thread see it as their own.
+ * @note This mechanism is intra-process only and cannot be shared between processes.
+ */
+typedef struct RWLock {
+	atomic_32           _state;       // Writer held and writer pending bits
+	atomic_32           _pending;     // Writers waiting for the lock
+	atomic_32           _drain;       // Bumped as readers leave while a writer is pending
+	atomic_64           _readers[DESCENT_RWLOCK_READER_WORDS]; // Reader set, unless sharded
+	atomic_64           _writer;
+	struct RWLockShard *_shards;
+	unsigned int        _shard_count;
+} RWLock;
+
+/**
+ * @brief Initializes a big-reader lock, whose reader set is spread across
+ * cache lines.
+ *
+ * Each managed thread reads through the shard at its index modulo
+ * @p count, so with @ref THREAD_MAX shards no two threads share a line. Each
+ * shard holds 64 threads, so there must be at least @ref THREAD_MAX / 64
+ * shards.
+ *
+ * @param r Pointer to the lock. Must not be held.
+ * @param shards Storage for the reader set, which must remain valid for the
+ * lifetime of the lock.
+ * @param count The number of shards. Must not be 0.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p r or @p shards is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p count is too small to hold every managed
+ *   thread.
+ */
+rcode rwlock_init_sharded(RWLock *r, struct RWLockShard *shards, unsigned int count);
+
+/**
+ * @brief Locks the lock for reading, blocking while a writer holds it or is
+ * waiting for it.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock acquired successfully.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref THREAD_ERROR_DEADLOCK: The calling thread already holds the lock.
+ */
+rcode rwlock_read_lock(RWLock *r);
+
+/**
+ * @brief Attempts to lock the lock for reading without blocking.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock acquired successfully.
+ * - @ref THREAD_INFO_BUSY: A writer holds the lock or is waiting for it.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref THREAD_ERROR_DEADLOCK: The calling thread already holds the lock.
+ */
+rcode rwlock_read_trylock(RWLock *r);
+
+/**
+ * @brief Releases a read lock.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock released successfully.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread does not hold the lock
+ *   for reading.
+ */
+rcode rwlock_read_unlock(RWLock *r);
+
+/**
+ * @brief Locks the lock for writing, blocking until all readers and any other
+ * writer have released it.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock acquired successfully.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref THREAD_ERROR_DEADLOCK: The calling thread already holds the lock.
+ */
+rcode rwlock_write_lock(RWLock *r);
+
+/**
+ * @brief Attempts to lock the lock for writing without blocking.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock acquired successfully.
+ * - @ref THREAD_INFO_BUSY: The lock is held, or another writer is waiting for it.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread is not managed.
+ * - @ref THREAD_ERROR_DEADLOCK: The calling thread already holds the lock.
+ */
+rcode rwlock_write_trylock(RWLock *r);
+
+/**
+ * @brief Atomically downgrades a write lock to a read lock.
+ *
+ * Waiting readers are let in alongside the calling thread, unless another
+ * writer is waiting. The lock must then be released with
+ * @ref rwlock_read_unlock.
+ *
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock downgraded successfully.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread does not hold the lock
+ *   for writing.
+ */
+rcode rwlock_downlock(RWLock *r);
+
+/**
+ * @brief Releases a write lock.
+ * @param r Pointer to the lock.
+ * @return
+ * - 0: Lock released successfully.
+ * - @ref DESCENT_ERROR_NULL: @p r is NULL.
+ * - @ref DESCENT_ERROR_FORBIDDEN: The calling thread does not hold the lock
+ *   for writing.
+ */
+rcode rwlock_write_unlock(RWLock *r);
+
+#endif
@@ -25,7 +25,7 @@
  * @param maximum The maximum count of the semaphore
  * @param initial The initial count of the semaphore
  */
-#define SEMAPHORE_INIT(maximum, initial) {._maximum = (maximum), ._count = ATOMIC_INIT(initial)}
+#define SEMAPHORE_INIT(maximum, initial) {._maximum = (maximum), ._count = ATOMIC_INIT(initial), ._spin = ATOMIC_INIT(0)}
 
 /**
  * @struct Semaphore
@@ -48,6 +48,7 @@
 struct Semaphore {
 	uint32_t _maximum;
 	atomic_32 _count;
+	atomic_32 _spin; // Learned spin budget
 };
 
 /**
@@ -55,7 +56,8 @@ struct Semaphore {
  *
  * If the semaphore count is greater than zero, it is decremented and the
  * function returns immediately. If the count is zero, the calling thread
- * blocks until another thread signals the semaphore.
+ * spins briefly, then blocks until another thread signals the semaphore. The
+ * number of spins is learned per semaphore from how long past waits took.
  *
  * This function may block indefinitely.
  *
@@ -0,0 +1,128 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_SEQLOCK_H
+#define DESCENT_THREAD_SEQLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic_types.h>
+
+/**
+ * @brief Static sequence lock initializer, equivalent to {0}.
+ */
+#define SEQLOCK_INIT {._sequence = ATOMIC_INIT(0)}
+
+/**
+ * @struct SeqLock
+ * @brief A sequence lock, for small data which is read often and written
+ * rarely.
+ *
+ * Writers bump a sequence counter before and after each update, and are
+ * serialized against each other. Readers copy the data without locking, then
+ * check that the sequence did not change while they copied, and retry if it
+ * did. Readers therefore never write to shared memory unless they have to
+ * wait for a writer, so any number of them can read without contending for a
+ * cache line.
+ *
+ * Data copied by a reader may be torn by a concurrent writer, and must not be
+ * acted on until @ref seqlock_read_retry confirms it. Data should be accessed
+ * through @ref seqlock_read and @ref seqlock_write, or with atomic operations,
+ * since plain accesses racing with a writer are undefined behaviour in C.
+ *
+ * Writers may starve readers, so sequence locks suit data such as frame timing,
+ * camera state, or configuration, which changes at most a few times a frame.
+ *
+ * @note This mechanism is intra-process only and cannot be shared between processes.
+ */
+struct SeqLock {
+	atomic_32 _sequence;
+};
+
+/**
+ * @brief Begins a read, waiting for any writer to finish.
+ *
+ * A writer which is in progress is waited out by spinning, and then by
+ * blocking.
+ *
+ * @param s Pointer to the sequence lock.
+ * @param sequence Receives the sequence to pass to @ref seqlock_read_retry.
+ * @return
+ * - 0: Read started successfully.
+ * - @ref DESCENT_ERROR_NULL: @p s or @p sequence is NULL.
+ */
+rcode seqlock_read_begin(struct SeqLock *s, uint32_t *sequence);
+
+/**
+ * @brief Ends a read, checking whether it must be retried.
+ * @param s Pointer to the sequence lock. Must not be NULL.
+ * @param sequence The sequence received from @ref seqlock_read_begin.
+ * @return True if a writer ran during the read, and the data read since
+ * @ref seqlock_read_begin must be discarded, false otherwise.
+ */
+bool seqlock_read_retry(struct SeqLock *s, uint32_t sequence);
+
+/**
+ * @brief Begins a write, blocking until other writers have finished.
+ *
+ * Readers which overlap the write will retry. The write must be ended with
+ * @ref seqlock_write_end.
+ *
+ * @param s Pointer to the sequence lock.
+ * @return
+ * - 0: Write started successfully.
+ * - @ref DESCENT_ERROR_NULL: @p s is NULL.
+ */
+rcode seqlock_write_begin(struct SeqLock *s);
+
+/**
+ * @brief Ends a write, publishing its updates to readers.
+ * @param s Pointer to the sequence lock.
+ * @return
+ * - 0: Write ended successfully.
+ * - @ref DESCENT_ERROR_NULL: @p s is NULL.
+ * - @ref DESCENT_ERROR_STATE: No write is in progress.
+ */
+rcode seqlock_write_end(struct SeqLock *s);
+
+/**
+ * @brief Copies a consistent snapshot of shared data, retrying until no writer
+ * interferes.
+ * @param s Pointer to the sequence lock guarding @p shared.
+ * @param data Receives the copy.
+ * @param shared The shared data.
+ * @param size The size of the data in bytes.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p s, @p data, or @p shared is NULL.
+ */
+rcode seqlock_read(struct SeqLock *s, void *data, const void *shared, size_t size);
+
+/**
+ * @brief Replaces shared data in a single write.
+ * @param s Pointer to the sequence lock guarding @p shared.
+ * @param shared The shared data.
+ * @param data The new data.
+ * @param size The size of the data in bytes.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p s, @p shared, or @p data is NULL.
+ */
+rcode seqlock_write(struct SeqLock *s, void *shared, const void *data, size_t size);
+
+#endif
@@ -20,6 +20,7 @@
 #include <stdbool.h>
 
 #include <descent/rcode.h>
+#include <descent/thread/topology.h>
 
 enum {
 	THREAD_STATE_INVALID = -1,
@@ -35,8 +36,8 @@ enum {
 // Unmanaged TIDS cannot use this library's threading functions
 
 // Persistent subsystems like rendering, audio, and networking can be implemented through
-// unique threads. Easily-parallelized tasks should be implemented through a job system
-// on worker threads.
+// unique threads. Easily-parallelized tasks should be implemented through the job system
+// on worker threads (see job.h).
 
 /**
  * @brief Gets the maximum number of unique threads that can be created.
@@ -61,11 +62,16 @@ unsigned int thread_worker_max(void);
  * function supports it.
  * @param name A name for the thread, used for debugging purposes. Should be
  * UTF-8 encoded. Can be NULL. Thread names may be truncated on some platforms.
+ * @param affinity The CPUs the thread may run on. Can be NULL, or empty, to let
+ * the OS place the thread freely. Pinning latency-sensitive threads such as
+ * rendering and audio keeps their caches warm. See @ref topology_mask.
  * @return 0 on success, non-zero error code on failure.
  * @note This function should only be called from the main thread. Calling it from
  * any other thread will return DESCENT_ERROR_FORBIDDEN.
+ * @note Pinning is applied by the thread as it starts. If the OS rejects the
+ * mask, the thread runs unpinned.
  */
-rcode thread_spawn_unique(unsigned int id, int (*function)(void *), void *argument, const char *name);
+rcode thread_spawn_unique(unsigned int id, int (*function)(void *), void *argument, const char *name, const struct CpuMask *affinity);
 
 /**
  * @brief Collects the unique thread on the given thread ID.
@@ -100,20 +106,29 @@ int thread_state_unique(unsigned int id);
 int thread_code_unique(unsigned int id);
 
 /**
- * @brief Spawns a batch of worker threads.
+ * @brief Spawns a batch of worker threads, or grows the current batch.
  * 
  * Worker threads implement a single function concurrently across multiple
  * threads. All worker threads invoke the same function and receive the same
  * argument.
  * 
- * Only one batch can be spawned and active at a time.
+ * Only one batch can be active at a time, but it can be grown by calling this
+ * function again with a larger count and the same function and argument.
+ * Workers which are already running are left untouched, and only the missing
+ * workers below @p count are spawned, including any which previously failed
+ * to spawn. Calling it again with the same count only retries those.
  * 
- * @param count The number of worker threads to spawn. Must not be greater than
- * thread_worker_max().
+ * @param count The number of worker threads in the batch. Must not be greater
+ * than thread_worker_max().
  * @param function The function invoked by the spawned threads. Must not be NULL.
  * @param argument The argument passed to each thread function. Can be NULL if the
  * function supports it.
- * @return 0 on success, non-zero error code on failure.
+ * @param affinity Array of @p count masks, indexed by worker ID, giving the CPUs
+ * each worker may run on. Can be NULL to let the OS place every worker freely, and an empty mask
+ * leaves its worker unpinned. See @ref topology_core_affinity.
+ * @return 0 on success, non-zero error code on failure. Returns
+ * THREAD_ERROR_ACTIVE if a batch is active and @p count is smaller than it, or
+ * @p function or @p argument differ from the ones it was spawned with.
  * @note This function should only be called from the main thread. Calling it from
  * any other thread will return DESCENT_ERROR_FORBIDDEN.
  * @note If any worker thread fails to spawn, this function will return
@@ -121,7 +136,13 @@ int thread_code_unique(unsigned int id);
  * THREAD_STATE_INCOMPLETE, and their code will be set to the relevant failure
  * code.
  */
-rcode thread_spawn_worker(unsigned int count, int (*function)(void *), void *argument);
+rcode thread_spawn_worker(unsigned int count, int (*function)(void *), void *argument, const struct CpuMask *affinity);
+
+/**
+ * @brief Gets the number of worker threads in the current batch.
+ * @return The number of worker threads, or 0 if no batch has been spawned.
+ */
+unsigned int thread_worker_count(void);
 
 /**
  * @brief Collects all worker threads.
@@ -0,0 +1,195 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_TOPOLOGY_H
+#define DESCENT_THREAD_TOPOLOGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+
+/**
+ * @brief The number of logical CPUs which can be described. CPUs with higher
+ * OS numbers are ignored.
+ */
+#ifndef DESCENT_TOPOLOGY_CPU_MAX
+#define DESCENT_TOPOLOGY_CPU_MAX 256u
+#endif
+
+#define CPU_MASK_WORDS ((DESCENT_TOPOLOGY_CPU_MAX + 63u) / 64u)
+
+/**
+ * @brief Static empty CPU mask initializer, equivalent to {0}.
+ */
+#define CPU_MASK_INIT {._bits = {0}}
+
+/**
+ * @struct CpuMask
+ * @brief A set of logical CPUs, indexed by their OS CPU number.
+ */
+struct CpuMask {
+	uint64_t _bits[CPU_MASK_WORDS];
+};
+
+/**
+ * @enum TopologyDomain
+ * @brief Levels of the CPU hierarchy which group logical CPUs.
+ */
+typedef enum {
+	TOPOLOGY_DOMAIN_CORE,    /**< Physical core, whose logical CPUs are SMT siblings */
+	TOPOLOGY_DOMAIN_CACHE,   /**< Last-level (usually L3) cache */
+	TOPOLOGY_DOMAIN_NODE,    /**< NUMA node */
+	TOPOLOGY_DOMAIN_PACKAGE, /**< Physical processor package */
+	TOPOLOGY_DOMAIN_COUNT
+} TopologyDomain;
+
+/**
+ * @struct TopologyCpu
+ * @brief Placement of one logical CPU.
+ *
+ * Domains are numbered densely from 0, in order of their lowest CPU.
+ */
+struct TopologyCpu {
+	unsigned int id;                            /**< OS CPU number */
+	unsigned int smt;                           /**< Index among the logical CPUs of its core */
+	unsigned int domain[TOPOLOGY_DOMAIN_COUNT]; /**< Index of each domain holding the CPU */
+};
+
+/**
+ * @struct Topology
+ * @brief The online logical CPUs, ordered by OS CPU number.
+ */
+struct Topology {
+	unsigned int       cpu_count;
+	unsigned int       domain_count[TOPOLOGY_DOMAIN_COUNT];
+	struct TopologyCpu cpus[DESCENT_TOPOLOGY_CPU_MAX];
+};
+
+/**
+ * @brief Adds a CPU to a CPU mask.
+ * @param m Pointer to the mask.
+ * @param cpu The OS CPU number. Ignored if not less than
+ * @ref DESCENT_TOPOLOGY_CPU_MAX.
+ */
+static inline void cpu_mask_add(struct CpuMask *m, unsigned int cpu) {
+	if (cpu < DESCENT_TOPOLOGY_CPU_MAX) m->_bits[cpu / 64u] |= 1ull << (cpu % 64u);
+}
+
+/**
+ * @brief Removes a CPU from a CPU mask.
+ * @param m Pointer to the mask.
+ * @param cpu The OS CPU number.
+ */
+static inline void cpu_mask_remove(struct CpuMask *m, unsigned int cpu) {
+	if (cpu < DESCENT_TOPOLOGY_CPU_MAX) m->_bits[cpu / 64u] &= ~(1ull << (cpu % 64u));
+}
+
+/**
+ * @brief Checks if a CPU mask contains a CPU.
+ * @param m Pointer to the mask.
+ * @param cpu The OS CPU number.
+ * @return True if the mask contains the CPU, false otherwise.
+ */
+static inline bool cpu_mask_contains(const struct CpuMask *m, unsigned int cpu) {
+	return cpu < DESCENT_TOPOLOGY_CPU_MAX && (m->_bits[cpu / 64u] & (1ull << (cpu % 64u)));
+}
+
+/**
+ * @brief Finds the lowest CPU in a mask at or after a CPU.
+ * @param m Pointer to the mask.
+ * @param cpu The OS CPU number to start from.
+ * @return The OS CPU number, or @ref DESCENT_TOPOLOGY_CPU_MAX if there is none.
+ */
+static inline unsigned int cpu_mask_next(const struct CpuMask *m, unsigned int cpu) {
+	for (; cpu < DESCENT_TOPOLOGY_CPU_MAX; cpu = (cpu | 63u) + 1) {
+		uint64_t bits = m->_bits[cpu / 64u] & ~((1ull << (cpu % 64u)) - 1);
+		if (bits) return (cpu & ~63u) + (unsigned int) __builtin_ctzll(bits);
+	}
+	return DESCENT_TOPOLOGY_CPU_MAX;
+}
+
+/**
+ * @brief Counts the CPUs in a mask.
+ * @param m Pointer to the mask.
+ * @return The number of CPUs.
+ */
+static inline unsigned int cpu_mask_count(const struct CpuMask *m) {
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < CPU_MASK_WORDS; ++i) count += (unsigned int) __builtin_popcountll(m->_bits[i]);
+	return count;
+}
+
+/**
+ * @brief Checks if a CPU mask is empty.
+ * @param m Pointer to the mask.
+ * @return True if the mask is empty, false otherwise.
+ */
+static inline bool cpu_mask_is_empty(const struct CpuMask *m) {
+	for (unsigned int i = 0; i < CPU_MASK_WORDS; ++i) {
+		if (m->_bits[i]) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Gets the CPU topology of the machine.
+ *
+ * The topology is discovered on the first call and cached. On Linux it is read
+ * from sysfs, and on Windows from GetLogicalProcessorInformationEx. Elsewhere,
+ * each online CPU is treated as its own core, sharing one cache, node and
+ * package.
+ *
+ * @param topology Receives a pointer to the topology, which remains valid for
+ * the lifetime of the process.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p topology is NULL.
+ * - @ref DESCENT_ERROR_OS: The topology could not be read.
+ */
+rcode topology_query(const struct Topology **topology);
+
+/**
+ * @brief Gets the logical CPUs in a domain.
+ * @param domain The level of the domain.
+ * @param index The index of the domain within its level.
+ * @param mask Receives the domain's CPUs.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p mask is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p domain or @p index is out of range.
+ * - Any error returned by @ref topology_query.
+ */
+rcode topology_mask(TopologyDomain domain, unsigned int index, struct CpuMask *mask);
+
+/**
+ * @brief Builds affinity masks which place one thread on each physical core.
+ *
+ * Each mask holds every SMT sibling of one core. Cores are taken cache domain
+ * by cache domain, so threads with neighbouring indices share a last-level
+ * cache, and the first threads are spread over as few caches as possible.
+ *
+ * @param affinity Receives up to @p count masks.
+ * @param count The capacity of @p affinity.
+ * @param written Receives the number of masks written, which is the lesser of
+ * @p count and the number of physical cores.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p affinity or @p written is NULL.
+ * - Any error returned by @ref topology_query.
+ */
+rcode topology_core_affinity(struct CpuMask *affinity, unsigned int count, unsigned int *written);
+
+#endif
@@ -0,0 +1,127 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_THREAD_WAIT_H
+#define DESCENT_THREAD_WAIT_H
+
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/condition.h>
+#include <descent/thread/job.h>
+#include <descent/thread/semaphore.h>
+
+/**
+ * @brief The maximum number of objects @ref wait_any can wait on.
+ */
+#define WAIT_ANY_MAX 128u
+
+/**
+ * @enum WaitType
+ * @brief The kinds of object @ref wait_any can wait on.
+ */
+typedef enum {
+	WAIT_TYPE_SEMAPHORE,   /**< Ready once the count is nonzero, and acquired when returned */
+	WAIT_TYPE_CONDITION,   /**< Ready once signaled since the object was initialized */
+	WAIT_TYPE_JOB_COUNTER, /**< Ready once the counter reaches zero */
+} WaitType;
+
+/**
+ * @brief Static initializer for waiting on a semaphore.
+ * @param s Pointer to the semaphore.
+ */
+#define WAIT_SEMAPHORE(s) {.type = WAIT_TYPE_SEMAPHORE, .object = (s), ._generation = 0}
+
+/**
+ * @brief Static initializer for waiting on a job counter.
+ * @param c Pointer to the job counter.
+ */
+#define WAIT_JOB_COUNTER(c) {.type = WAIT_TYPE_JOB_COUNTER, .object = (c), ._generation = 0}
+
+/**
+ * @struct WaitObject
+ * @brief One object of a multi-wait.
+ *
+ * Conditions carry no state, so a wait on a condition must be initialized with
+ * @ref wait_condition at the point from which signals count, typically while
+ * still holding the lock which guards the predicate.
+ */
+struct WaitObject {
+	WaitType type;
+	void    *object;
+	uint32_t _generation;
+};
+
+/**
+ * @brief Initializes a wait on a condition variable, which becomes ready once
+ * the condition is signaled or broadcast after this call.
+ * @param w Pointer to the wait object.
+ * @param c Pointer to the condition variable.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p w or @p c is NULL.
+ */
+rcode wait_condition(struct WaitObject *w, struct Condition *c);
+
+/**
+ * @brief Blocks until any of several objects is ready.
+ *
+ * Objects are checked in order, so earlier objects take priority when several
+ * are ready. A thread serving several queues can wait on all of them at once,
+ * rather than polling each with a timeout.
+ *
+ * Waits use @ref futex_wait_any, so on platforms without a native multi-wait,
+ * unrelated wakes cause spurious rechecks.
+ *
+ * @param objects The objects to wait on.
+ * @param count The number of objects. Must not be 0 or greater than
+ * @ref WAIT_ANY_MAX.
+ * @param index Receives the index of the object which became ready. Can be
+ * NULL.
+ * @return
+ * - 0: Success.
+ * - @ref DESCENT_ERROR_NULL: @p objects or one of its objects is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p count is out of range, or an object's type
+ *   is invalid.
+ * - Any error returned by @ref futex_wait_any.
+ * @warning Job counters are waited on without running jobs, so a job should
+ * use @ref job_wait instead.
+ */
+rcode wait_any(struct WaitObject *objects, unsigned int count, unsigned int *index);
+
+/**
+ * @brief Blocks until any of several objects is ready, up to the specified
+ * timeout.
+ *
+ * Behaves as @ref wait_any, but gives up once the timeout expires. Timeouts
+ * are capped at the value returned by @ref time_max_timeout().
+ *
+ * @param objects The objects to wait on.
+ * @param count The number of objects. Must not be 0 or greater than
+ * @ref WAIT_ANY_MAX.
+ * @param index Receives the index of the object which became ready. Can be
+ * NULL.
+ * @param nanoseconds The maximum number of nanoseconds to wait.
+ * @return
+ * - 0: Success.
+ * - @ref THREAD_INFO_TIMEOUT: No object became ready within the timeout.
+ * - @ref DESCENT_ERROR_NULL: @p objects or one of its objects is NULL.
+ * - @ref DESCENT_ERROR_INVALID: @p count is out of range, or an object's type
+ *   is invalid.
+ * - Any error returned by @ref futex_timedwait_any.
+ */
+rcode wait_any_timed(struct WaitObject *objects, unsigned int count, unsigned int *index, uint64_t nanoseconds);
+
+#endif
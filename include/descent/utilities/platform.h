@@ -87,6 +87,13 @@
 #error "Descent Engine does not support this architecture!"
 #endif
 
+// Cache Line
+
+// Used to keep independently-written shared data on separate cache lines
+#ifndef DESCENT_PLATFORM_CACHE_LINE
+#define DESCENT_PLATFORM_CACHE_LINE 64
+#endif
+
 // Language
 
 #if defined(__STDC_VERSION__) && __STDC_VERSION__ < 201112L
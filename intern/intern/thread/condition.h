@@ -0,0 +1,41 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_INTERN_THREAD_CONDITION_H
+#define DESCENT_INTERN_THREAD_CONDITION_H
+
+#include <stdint.h>
+
+#include <descent/thread/atomic.h>
+#include <descent/thread/condition.h>
+
+// Recorded once waiters have used different locks, after which broadcasts
+// wake every waiter instead of requeueing them onto one lock
+#define CONDITION_REQUEUE_MIXED ((uintptr_t) 1)
+
+// Records the futex of the lock a condition is about to be waited with. The
+// first lock is kept, and any other lock marks the condition as mixed for
+// good, since a requeue would strand its waiters on the wrong lock.
+static inline void condition_record_lock(struct Condition *c, atomic_32 *lock) {
+	uintptr_t desired = (uintptr_t) lock;
+	uintptr_t current = atomic_load_ptr(&c->_requeue, ATOMIC_SEQ_CST);
+
+	while (current != desired && current != CONDITION_REQUEUE_MIXED) {
+		uintptr_t next = current ? CONDITION_REQUEUE_MIXED : desired;
+		if (atomic_compare_exchange_ptr(&c->_requeue, &current, next, ATOMIC_SEQ_CST, ATOMIC_SEQ_CST)) return;
+	}
+}
+
+#endif
@@ -16,6 +16,8 @@
 #ifndef DESCENT_THREAD_HINTS_H
 #define DESCENT_THREAD_HINTS_H
 
+#include <descent/utilities/platform.h>
+
 static inline void thread_spin_hint(void) {
 #if defined(DESCENT_PLATFORM_ARCHITECTURE_FAMILY_X86)
 	__asm__ volatile("pause" ::: "memory");
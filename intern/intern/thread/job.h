@@ -0,0 +1,63 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_INTERN_THREAD_JOB_H
+#define DESCENT_INTERN_THREAD_JOB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <descent/thread/atomic_types.h>
+#include <descent/thread/job.h>
+
+/**
+ * @brief Checks whether other threads are likely to take more work from the
+ * calling thread.
+ *
+ * True when the job system is running and the calling thread's queue is empty,
+ * either because nothing was submitted or because everything submitted has
+ * been stolen. Used to split work lazily, only as fast as it is taken.
+ *
+ * @return Whether submitting more work is worthwhile.
+ */
+bool job_demand(void);
+
+/**
+ * @brief Prepares to block until a job counter reaches zero, for waits which
+ * cannot run jobs in the meantime.
+ *
+ * Marks the counter as waited on, so that finishing it wakes the futex the
+ * job system's idle threads park on.
+ *
+ * @param counter The counter to wait on.
+ * @param futex Receives the futex to wait on.
+ * @param expected Receives the value to wait on @p futex with.
+ * @return False if the counter is already zero, true otherwise.
+ */
+bool job_counter_park(struct JobCounter *counter, atomic_32 **futex, uint32_t *expected);
+
+/**
+ * @brief Gets the job fiber the calling thread is running on.
+ *
+ * A job running on a fiber may resume on another thread after
+ * @ref job_wait(), so state which follows the job is kept per fiber rather
+ * than per thread.
+ *
+ * @return The fiber's index + 1, or 0 if the calling thread is not running a
+ * job fiber.
+ */
+unsigned int job_fiber_self(void);
+
+#endif
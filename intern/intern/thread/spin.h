@@ -0,0 +1,57 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DESCENT_INTERN_THREAD_SPIN_H
+#define DESCENT_INTERN_THREAD_SPIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <descent/thread/atomic.h>
+
+// Upper bound on spin iterations before parking, regardless of what is learned
+#ifndef DESCENT_SPIN_LIMIT
+#define DESCENT_SPIN_LIMIT 256u
+#endif
+
+// Lower bound on the learned budget, so that a primitive whose spins keep
+// failing still probes occasionally and can learn again if its holders change
+#define SPIN_BUDGET_MIN 8u
+
+// Spin budgets are learned per primitive, from how many iterations past spin
+// phases took to succeed. Each phase may spin up to twice the budget, so the
+// budget can grow when acquisitions take longer than expected, and a phase
+// which ends in parking decays it. The budget is a heuristic, so races on it
+// are harmless.
+
+// Gets the number of iterations the next spin phase may take
+static inline uint32_t spin_limit(atomic_32 *budget) {
+	uint32_t limit = 2 * atomic_load_32(budget, ATOMIC_RELAXED) + SPIN_BUDGET_MIN;
+	return limit < DESCENT_SPIN_LIMIT ? limit : DESCENT_SPIN_LIMIT;
+}
+
+// Moves the budget an eighth of the way towards the outcome of a spin phase
+static inline void spin_learn(atomic_32 *budget, uint32_t spins, bool acquired) {
+	int32_t current = (int32_t) atomic_load_32(budget, ATOMIC_RELAXED);
+	int32_t target = acquired ? (int32_t) spins : current / 2;
+
+	int32_t next = current + (target - current) / 8;
+	if (next < (int32_t) SPIN_BUDGET_MIN) next = SPIN_BUDGET_MIN;
+	if (next > (int32_t) DESCENT_SPIN_LIMIT) next = DESCENT_SPIN_LIMIT;
+
+	atomic_store_32(budget, (uint32_t) next, ATOMIC_RELAXED);
+}
+
+#endif
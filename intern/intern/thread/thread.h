@@ -21,7 +21,7 @@
 #endif
 
 #ifndef DESCENT_WORKER_THREAD_COUNT_MAX
-#define DESCENT_WORKER_THREAD_COUNT_MAX 48u
+#define DESCENT_WORKER_THREAD_COUNT_MAX 240u
 #endif
 
 #ifndef DESCENT_THREAD_NAME_SIZE
@@ -30,6 +30,6 @@
 
 // Main thread + unique threads + worker threads
 #define THREAD_MAX (1 + DESCENT_UNIQUE_THREAD_COUNT_MAX + DESCENT_WORKER_THREAD_COUNT_MAX)
-_Static_assert(THREAD_MAX <= 64, "Maximum managed thread count must not exceed 64");
+_Static_assert(THREAD_MAX <= 4096, "Maximum managed thread count must not exceed 4096");
 
 #endif
@@ -20,22 +20,43 @@
 #include <stdint.h>
 
 #include <descent/rcode.h>
+#include <descent/thread/atomic.h>
 #include <intern/thread/thread.h>
 
+// Thread IDs are dense: each managed thread's ID is its index plus one, so
+// that the ID fits in a single word for cheap ownership checks, and zero is
+// left for no thread. The main thread comes first, then unique threads, then
+// workers.
+
 #define TID_NONE 0ull /**< No thread assigned */
 #define TID_MAIN 1ull /**< Main thread ID */
 
-#define BIT_RANGE_MASK(min, max) (((1ull << ((max) - (min) + 1)) - 1ull) << (min))
+#define TID_UNIQUE_MIN 2ull
+#define TID_WORKER_MIN (TID_UNIQUE_MIN + DESCENT_UNIQUE_THREAD_COUNT_MAX)
+
+/**
+ * @brief The number of 64-bit words in a thread ID set.
+ */
+#define TID_SET_WORDS ((THREAD_MAX + 63u) / 64u)
 
-#define TID_UNIQUE_INDEX_MIN 1ull
-#define TID_UNIQUE_INDEX_MAX DESCENT_UNIQUE_THREAD_COUNT_MAX
-#define TID_WORKER_INDEX_MIN (DESCENT_UNIQUE_THREAD_COUNT_MAX + 1ull)
-#define TID_WORKER_INDEX_MAX (DESCENT_UNIQUE_THREAD_COUNT_MAX + DESCENT_WORKER_THREAD_COUNT_MAX)
-#define TID_UNIQUE_MASK      BIT_RANGE_MASK(TID_UNIQUE_INDEX_MIN, TID_UNIQUE_INDEX_MAX)
-#define TID_WORKER_MASK      BIT_RANGE_MASK(TID_WORKER_INDEX_MIN, TID_WORKER_INDEX_MAX)
+typedef uint64_t thread_id; /**< Single-thread identifier (index plus one) */
 
-typedef uint64_t thread_id;     /**< Single-thread identifier (one bit set) */
-typedef uint64_t thread_id_set; /**< Set of thread IDs (bitmask) */
+/**
+ * @brief Set of thread IDs, as a bitmask indexed by thread index.
+ */
+typedef struct {
+	uint64_t words[TID_SET_WORDS];
+} thread_id_set;
+
+/**
+ * @brief Set of thread IDs which may be modified concurrently.
+ *
+ * Each word is updated atomically, but a set is not loaded atomically as a
+ * whole.
+ */
+typedef struct {
+	atomic_64 words[TID_SET_WORDS];
+} thread_id_atomic_set;
 
 /**
  * @brief Returns the calling thread's ID.
@@ -49,9 +70,8 @@ thread_id tid_self(void);
  * @return Corresponding thread_id, or TID_NONE if out of range.
  */
 static inline thread_id tid_generate_unique(unsigned int index) {
-	// index is zero-based, maps to bit [TID_UNIQUE_INDEX_MIN + index]
 	if (index >= DESCENT_UNIQUE_THREAD_COUNT_MAX) return TID_NONE;
-	return 1ull << (TID_UNIQUE_INDEX_MIN + index);
+	return TID_UNIQUE_MIN + index;
 }
 
 /**
@@ -60,9 +80,8 @@ static inline thread_id tid_generate_unique(unsigned int index) {
  * @return Corresponding thread_id, or TID_NONE if out of range.
  */
 static inline thread_id tid_generate_worker(unsigned int index) {
-	// index is zero-based, maps to bit [TID_WORKER_INDEX_MIN + index]
 	if (index >= DESCENT_WORKER_THREAD_COUNT_MAX) return TID_NONE;
-	return 1ull << (TID_WORKER_INDEX_MIN + index);
+	return TID_WORKER_MIN + index;
 }
 
 /**
@@ -80,11 +99,7 @@ static inline bool tid_is_main(thread_id t) {
  * @return True if the thread ID represents a unique thread, false otherwise.
  */
 static inline bool tid_is_unique(thread_id t) {
-	// This checks that only one bit is set
-	// - "(t & TID_UNIQUE_MASK)" is true if "t" is nonzero and within the mask
-	// - "t & (t - 1)" is equal to "t" with the least significant set bit cleared
-	// - "!(t & (t - 1))" is therefore true if one or zero bits were set
-	return (t & TID_UNIQUE_MASK) && !(t & (t - 1));
+	return t - TID_UNIQUE_MIN < DESCENT_UNIQUE_THREAD_COUNT_MAX;
 }
 
 /**
@@ -93,7 +108,7 @@ static inline bool tid_is_unique(thread_id t) {
  * @return True if the thread ID represents a worker thread, false otherwise.
  */
 static inline bool tid_is_worker(thread_id t) {
-	return (t & TID_WORKER_MASK) && !(t & (t - 1));
+	return t - TID_WORKER_MIN < DESCENT_WORKER_THREAD_COUNT_MAX;
 }
 
 /**
@@ -103,7 +118,29 @@ static inline bool tid_is_worker(thread_id t) {
  * @return True if the thread ID represents a managed thread, false otherwise.
  */
 static inline bool tid_is_managed(thread_id t) {
-	return (t & (TID_MAIN | TID_UNIQUE_MASK | TID_WORKER_MASK)) && !(t & (t - 1));
+	// TID_NONE wraps around to the largest value
+	return t - TID_MAIN < THREAD_MAX;
+}
+
+/**
+ * @brief Converts a managed thread ID to a dense zero-based index, suitable for
+ * indexing per-thread arrays of THREAD_MAX elements.
+ * @param t The thread ID to convert.
+ * @return The thread's index, or THREAD_MAX if the thread ID is not managed.
+ */
+static inline unsigned int tid_index(thread_id t) {
+	if (!tid_is_managed(t)) return THREAD_MAX;
+	return (unsigned int) (t - TID_MAIN);
+}
+
+/**
+ * @brief Converts a dense zero-based index back to a thread ID.
+ * @param index The thread's index.
+ * @return The thread ID, or TID_NONE if the index is out of range.
+ */
+static inline thread_id tid_from_index(unsigned int index) {
+	if (index >= THREAD_MAX) return TID_NONE;
+	return TID_MAIN + index;
 }
 
 /**
@@ -130,7 +167,7 @@ bool tid_is_assigned(thread_id t);
  *   assigned.
  * - @ref DESCENT_ERROR_STATE if the requested ID is already assigned to
  *   another thread.
- * - @ref DESCENT_ERROR_INVALID if the requested id is TID_NONE.
+ * - @ref DESCENT_ERROR_INVALID if the requested id is not a managed thread ID.
  */
 rcode tid_assign(thread_id t);
 
@@ -178,6 +215,24 @@ rcode tid_assign_worker(unsigned int index);
  */
 void tid_assign_clear(void);
 
+/**
+ * @brief Gets the word of a thread ID set which holds a thread index.
+ * @param index The thread's index. Must be less than THREAD_MAX.
+ * @return The index of the word.
+ */
+static inline unsigned int tid_set_word(unsigned int index) {
+	return index / 64u;
+}
+
+/**
+ * @brief Gets the bit of a thread ID set word which represents a thread index.
+ * @param index The thread's index. Must be less than THREAD_MAX.
+ * @return The bit within the word.
+ */
+static inline uint64_t tid_set_bit(unsigned int index) {
+	return 1ull << (index % 64u);
+}
+
 /**
  * @brief Adds a managed thread ID to a thread ID set.
  * @param s The thread ID set to modify.
@@ -185,7 +240,9 @@ void tid_assign_clear(void);
  * @return The updated thread ID set.
  */
 static inline thread_id_set tid_set_add(thread_id_set s, thread_id t) {
-	return tid_is_managed(t) ? (s | t) : s;
+	unsigned int index = tid_index(t);
+	if (index < THREAD_MAX) s.words[tid_set_word(index)] |= tid_set_bit(index);
+	return s;
 }
 
 /**
@@ -195,7 +252,9 @@ static inline thread_id_set tid_set_add(thread_id_set s, thread_id t) {
  * @return The updated thread ID set.
  */
 static inline thread_id_set tid_set_remove(thread_id_set s, thread_id t) {
-	return tid_is_managed(t) ? (s & ~t) : s;
+	unsigned int index = tid_index(t);
+	if (index < THREAD_MAX) s.words[tid_set_word(index)] &= ~tid_set_bit(index);
+	return s;
 }
 
 /**
@@ -205,7 +264,19 @@ static inline thread_id_set tid_set_remove(thread_id_set s, thread_id t) {
  * @return The joined thread ID set.
  */
 static inline thread_id_set tid_set_union(thread_id_set s1, thread_id_set s2) {
-	return s1 | s2;
+	for (unsigned int i = 0; i < TID_SET_WORDS; ++i) s1.words[i] |= s2.words[i];
+	return s1;
+}
+
+/**
+ * @brief Creates an intersection of two thread ID sets.
+ * @param s1 The first thread ID set to intersect.
+ * @param s2 The second thread ID set to intersect.
+ * @return The thread IDs contained in both sets.
+ */
+static inline thread_id_set tid_set_intersection(thread_id_set s1, thread_id_set s2) {
+	for (unsigned int i = 0; i < TID_SET_WORDS; ++i) s1.words[i] &= s2.words[i];
+	return s1;
 }
 
 /**
@@ -215,7 +286,8 @@ static inline thread_id_set tid_set_union(thread_id_set s1, thread_id_set s2) {
  * @return True if the thread ID set contains the thread ID, false otherwise.
  */
 static inline bool tid_set_contains(thread_id_set s, thread_id t) {
-	return tid_is_managed(t) && (s & t);
+	unsigned int index = tid_index(t);
+	return index < THREAD_MAX && (s.words[tid_set_word(index)] & tid_set_bit(index));
 }
 
 /**
@@ -226,18 +298,21 @@ static inline bool tid_set_contains(thread_id_set s, thread_id t) {
  * otherwise.
  */
 static inline bool tid_set_intersects(thread_id_set s1, thread_id_set s2) {
-	return s1 & s2;
+	for (unsigned int i = 0; i < TID_SET_WORDS; ++i) {
+		if (s1.words[i] & s2.words[i]) return true;
+	}
+	return false;
 }
 
 /**
- * @brief Returns true if the thread ID set contains only managed thread IDs
- * (main, unique, or worker).
+ * @brief Checks if the thread ID set contains only managed thread IDs.
  * @param s The thread ID set to check.
  * @return True if the thread ID set contains only managed thread IDs, false
  * otherwise.
  */
 static inline bool tid_set_is_managed(thread_id_set s) {
-	return !(s & ~(TID_MAIN | TID_UNIQUE_MASK | TID_WORKER_MASK));
+	if (THREAD_MAX % 64u == 0) return true;
+	return !(s.words[TID_SET_WORDS - 1] & ~((1ull << (THREAD_MAX % 64u)) - 1));
 }
 
 /**
@@ -246,7 +321,38 @@ static inline bool tid_set_is_managed(thread_id_set s) {
  * @return True if the thread ID set is empty, false otherwise.
  */
 static inline bool tid_set_is_empty(thread_id_set s) {
-	return !(s & (TID_MAIN | TID_UNIQUE_MASK | TID_WORKER_MASK));
+	for (unsigned int i = 0; i < TID_SET_WORDS; ++i) {
+		if (s.words[i]) return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Finds the first thread in a set at or after an index.
+ *
+ * Iterates a set in index order with
+ * `for (i = tid_set_next(&s, 0); i < THREAD_MAX; i = tid_set_next(&s, i + 1))`.
+ *
+ * @param s The thread ID set to search.
+ * @param index The index to start from.
+ * @return The index of the first thread in the set at or after @p index, or
+ * THREAD_MAX if there is none.
+ */
+static inline unsigned int tid_set_next(const thread_id_set *s, unsigned int index) {
+	if (index >= THREAD_MAX) return THREAD_MAX;
+
+	unsigned int word = tid_set_word(index);
+	uint64_t bits = s->words[word] & ~(tid_set_bit(index) - 1);
+
+	for (;;) {
+		if (bits) {
+			unsigned int next = word * 64u + (unsigned int) __builtin_ctzll(bits);
+			return next < THREAD_MAX ? next : THREAD_MAX;
+		}
+
+		if (++word >= TID_SET_WORDS) return THREAD_MAX;
+		bits = s->words[word];
+	}
 }
 
 /**
@@ -257,12 +363,55 @@ static inline bool tid_set_is_empty(thread_id_set s) {
  */
 bool tid_set_contains_self(thread_id_set s);
 
-#undef TID_WORKER_MASK
-#undef TID_UNIQUE_MASK
-#undef TID_WORKER_INDEX_MAX
-#undef TID_WORKER_INDEX_MIN
-#undef TID_UNIQUE_INDEX_MAX
-#undef TID_UNIQUE_INDEX_MIN
-#undef BIT_RANGE_MASK
+/**
+ * @brief Adds a managed thread ID to a concurrent thread ID set.
+ * @param s The thread ID set to modify.
+ * @param t The thread ID to add.
+ * @param order The memory order of the update.
+ * @return True if the thread ID was already in the set, false otherwise.
+ */
+static inline bool tid_atomic_set_add(thread_id_atomic_set *s, thread_id t, int order) {
+	unsigned int index = tid_index(t);
+	if (index >= THREAD_MAX) return false;
+	return atomic_fetch_or_64(&s->words[tid_set_word(index)], tid_set_bit(index), order) & tid_set_bit(index);
+}
+
+/**
+ * @brief Removes a managed thread ID from a concurrent thread ID set.
+ * @param s The thread ID set to modify.
+ * @param t The thread ID to remove.
+ * @param order The memory order of the update.
+ */
+static inline void tid_atomic_set_remove(thread_id_atomic_set *s, thread_id t, int order) {
+	unsigned int index = tid_index(t);
+	if (index < THREAD_MAX) atomic_fetch_and_64(&s->words[tid_set_word(index)], ~tid_set_bit(index), order);
+}
+
+/**
+ * @brief Checks if a concurrent thread ID set contains the specified thread ID.
+ * @param s The thread ID set to check.
+ * @param t The thread ID to check.
+ * @param order The memory order of the load.
+ * @return True if the thread ID set contains the thread ID, false otherwise.
+ */
+static inline bool tid_atomic_set_contains(thread_id_atomic_set *s, thread_id t, int order) {
+	unsigned int index = tid_index(t);
+	return index < THREAD_MAX && (atomic_load_64(&s->words[tid_set_word(index)], order) & tid_set_bit(index));
+}
+
+/**
+ * @brief Loads a snapshot of a concurrent thread ID set, one word at a time.
+ * @param s The thread ID set to load.
+ * @param order The memory order of each word's load.
+ * @return The loaded thread ID set.
+ */
+static inline thread_id_set tid_atomic_set_load(thread_id_atomic_set *s, int order) {
+	thread_id_set result;
+	for (unsigned int i = 0; i < TID_SET_WORDS; ++i) result.words[i] = atomic_load_64(&s->words[i], order);
+	return result;
+}
+
+#undef TID_WORKER_MIN
+#undef TID_UNIQUE_MIN
 
 #endif
@@ -0,0 +1,243 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/utilities/platform.h>
+#if defined(DESCENT_PLATFORM_LINUX)
+#define _GNU_SOURCE
+#endif
+
+#include <descent/alloc/ring.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/utilities/macros.h>
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+static inline rcode ring_errno(void) {
+	switch (errno) {
+		case ENOMEM:
+		case ENFILE:
+		case EMFILE:
+		case EFBIG:
+			return DESCENT_ERROR_MEMORY;
+		case ENOSYS:
+			return DESCENT_ERROR_UNSUPPORTED;
+		default:
+			return DESCENT_ERROR_OS;
+	}
+}
+
+static rcode ring_map(void **base, size_t size) {
+#if defined(DESCENT_PLATFORM_LINUX)
+	int fd = memfd_create("descent-ring", MFD_CLOEXEC);
+#elif defined(DESCENT_PLATFORM_FREEBSD)
+	int fd = shm_open(SHM_ANON, O_RDWR | O_CLOEXEC, 0600);
+#endif
+	if (fd < 0) return ring_errno();
+
+	if (ftruncate(fd, (off_t) size)) {
+		rcode result = ring_errno();
+		close(fd);
+		return result;
+	}
+
+	// Reserve both halves so that nothing else can be mapped between them
+	void *reservation = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reservation == MAP_FAILED) {
+		rcode result = ring_errno();
+		close(fd);
+		return result;
+	}
+
+	void *lower = mmap(reservation, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+	void *upper = MAP_FAILED;
+	if (lower != MAP_FAILED) {
+		upper = mmap(POINTER_OFFSET(void, reservation, size), size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+	}
+
+	// The mappings keep the memory alive without the descriptor
+	rcode result = (upper == MAP_FAILED) ? ring_errno() : 0;
+	close(fd);
+
+	if (result) {
+		munmap(reservation, 2 * size);
+		return result;
+	}
+
+	*base = reservation;
+	return 0;
+}
+
+static rcode ring_unmap(void *base, size_t size) {
+	if (munmap(base, 2 * size)) {
+		switch (errno) {
+			case EINVAL:
+				return ALLOCATOR_ERROR_FREE;
+			default:
+				return DESCENT_ERROR_OS;
+		}
+	}
+
+	return 0;
+}
+
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+
+// Without placeholder APIs, a free range cannot be held while mapping into it,
+// so another thread may take it first
+#define RING_MAP_ATTEMPTS 16
+
+static rcode ring_map(void **base, size_t size) {
+	uint64_t size_64 = (uint64_t) size;
+	HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD) (size_64 >> 32), (DWORD) size_64, NULL);
+	if (!mapping) {
+		return GetLastError() == ERROR_NOT_ENOUGH_MEMORY ? DESCENT_ERROR_MEMORY : DESCENT_ERROR_OS;
+	}
+
+	rcode result = DESCENT_ERROR_OS;
+
+	for (int attempt = 0; attempt < RING_MAP_ATTEMPTS; ++attempt) {
+		// Find a free range large enough for both views, then release it
+		void *reservation = VirtualAlloc(NULL, 2 * size, MEM_RESERVE, PAGE_NOACCESS);
+		if (!reservation) {
+			result = DESCENT_ERROR_MEMORY;
+			break;
+		}
+		VirtualFree(reservation, 0, MEM_RELEASE);
+
+		void *lower = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, reservation);
+		if (!lower) continue;
+
+		void *upper = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, POINTER_OFFSET(void, reservation, size));
+		if (!upper) {
+			UnmapViewOfFile(lower);
+			continue;
+		}
+
+		*base = reservation;
+		result = 0;
+		break;
+	}
+
+	// The views keep the memory alive without the mapping handle
+	CloseHandle(mapping);
+	return result;
+}
+
+static rcode ring_unmap(void *base, size_t size) {
+	if (!UnmapViewOfFile(POINTER_OFFSET(void, base, size))) return ALLOCATOR_ERROR_FREE;
+	if (!UnmapViewOfFile(base)) return ALLOCATOR_ERROR_FREE;
+	return 0;
+}
+
+#endif
+
+rcode ring_init(RingBuffer *r, size_t capacity) {
+	if (!r) return DESCENT_ERROR_NULL;
+
+	memset(r, 0, sizeof(*r));
+
+	if (!capacity) return DESCENT_ERROR_INVALID;
+	if (capacity > DESCENT_MAX_ALLOC / 2) return DESCENT_ERROR_OVERFLOW;
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+
+	// Both views must start on an allocation boundary
+	capacity = (capacity + granularity - 1) & ~(granularity - 1);
+
+	void *base = NULL;
+	rcode result = ring_map(&base, capacity);
+	if (result) return result;
+
+	r->_base = base;
+	r->_capacity = capacity;
+	return 0;
+}
+
+rcode ring_release(RingBuffer *r) {
+	if (!r) return DESCENT_ERROR_NULL;
+	if (!r->_base) return ALLOCATOR_ERROR_FREE;
+
+	rcode result = ring_unmap(r->_base, r->_capacity);
+	if (result) return result;
+
+	memset(r, 0, sizeof(*r));
+	return 0;
+}
+
+void *ring_write_span(RingBuffer *r, size_t *size) {
+	if (!r || !size) return NULL;
+
+	// The tail is only written by this thread
+	uint64_t tail = atomic_load_64(&r->_tail, ATOMIC_RELAXED);
+	uint64_t head = atomic_load_64(&r->_head, ATOMIC_ACQUIRE);
+
+	*size = r->_capacity - (size_t) (tail - head);
+	return POINTER_OFFSET(void, r->_base, tail % r->_capacity);
+}
+
+rcode ring_write_commit(RingBuffer *r, size_t size) {
+	if (!r) return DESCENT_ERROR_NULL;
+
+	uint64_t tail = atomic_load_64(&r->_tail, ATOMIC_RELAXED);
+	uint64_t head = atomic_load_64(&r->_head, ATOMIC_ACQUIRE);
+	if (size > r->_capacity - (size_t) (tail - head)) return DESCENT_ERROR_OVERFLOW;
+
+	atomic_store_64(&r->_tail, tail + size, ATOMIC_RELEASE);
+	return 0;
+}
+
+void *ring_read_span(RingBuffer *r, size_t *size) {
+	if (!r || !size) return NULL;
+
+	// The head is only written by this thread
+	uint64_t head = atomic_load_64(&r->_head, ATOMIC_RELAXED);
+	uint64_t tail = atomic_load_64(&r->_tail, ATOMIC_ACQUIRE);
+
+	*size = (size_t) (tail - head);
+	return POINTER_OFFSET(void, r->_base, head % r->_capacity);
+}
+
+rcode ring_read_consume(RingBuffer *r, size_t size) {
+	if (!r) return DESCENT_ERROR_NULL;
+
+	uint64_t head = atomic_load_64(&r->_head, ATOMIC_RELAXED);
+	uint64_t tail = atomic_load_64(&r->_tail, ATOMIC_ACQUIRE);
+	if (size > (size_t) (tail - head)) return DESCENT_ERROR_OVERFLOW;
+
+	atomic_store_64(&r->_head, head + size, ATOMIC_RELEASE);
+	return 0;
+}
@@ -0,0 +1,141 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/alloc/slotmap.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/alloc/varray.h>
+#include <descent/rcode.h>
+
+#define SLOT_FREE_NONE UINT32_MAX
+
+static inline slot_handle slot_handle_make(uint32_t index, uint32_t generation) {
+	return (slot_handle) (((slot_handle) generation << SLOT_INDEX_BITS) | index);
+}
+
+rcode slotmap_init(Slotmap *m, size_t element_size, size_t capacity) {
+	if (!m) return DESCENT_ERROR_NULL;
+
+	memset(m, 0, sizeof(*m));
+	m->_free = SLOT_FREE_NONE;
+
+	if (!element_size || !capacity) return DESCENT_ERROR_INVALID;
+	if (capacity > SLOTMAP_CAPACITY_MAX) return DESCENT_ERROR_OVERFLOW;
+
+	rcode result = varray_init(&m->_dense, element_size, capacity);
+	if (!result) result = varray_init(&m->_owners, sizeof(uint32_t), capacity);
+	if (!result) result = varray_init(&m->_slots, sizeof(SlotmapSlot), capacity);
+
+	if (result) slotmap_release(m);
+	return result;
+}
+
+rcode slotmap_release(Slotmap *m) {
+	if (!m) return DESCENT_ERROR_NULL;
+
+	rcode result = varray_release(&m->_dense);
+	rcode owners = varray_release(&m->_owners);
+	rcode slots = varray_release(&m->_slots);
+	if (!result) result = owners;
+	if (!result) result = slots;
+
+	m->_free = SLOT_FREE_NONE;
+	return result;
+}
+
+rcode slotmap_insert(Slotmap *m, const void *element, slot_handle *handle, void **out) {
+	if (!m || !handle) return DESCENT_ERROR_NULL;
+
+	size_t count = varray_count(&m->_dense);
+	if (count >= varray_capacity(&m->_dense)) return DESCENT_ERROR_OVERFLOW;
+
+	// Reuse a free slot, or create one if there are none
+	SlotmapSlot *slot = NULL;
+	uint32_t index = m->_free;
+	if (index != SLOT_FREE_NONE) {
+		slot = varray_at(&m->_slots, index);
+	}
+	else {
+		index = (uint32_t) varray_count(&m->_slots);
+		SlotmapSlot fresh = {.dense = SLOT_FREE_NONE, .generation = 1};
+		rcode result = varray_push(&m->_slots, 1, &fresh, (void **) &slot);
+		if (result) return result;
+	}
+
+	// Commit the element before taking the slot, so failure leaves no trace
+	void *stored = NULL;
+	rcode result = varray_push(&m->_dense, 1, element, &stored);
+	if (result) {
+		if (index != m->_free) varray_pop(&m->_slots, NULL);
+		return result;
+	}
+
+	result = varray_push(&m->_owners, 1, &index, NULL);
+	if (result) {
+		varray_pop(&m->_dense, NULL);
+		if (index != m->_free) varray_pop(&m->_slots, NULL);
+		return result;
+	}
+
+	if (index == m->_free) m->_free = slot->dense;
+	slot->dense = (uint32_t) count;
+
+	*handle = slot_handle_make(index, slot->generation);
+	if (out) *out = stored;
+	return 0;
+}
+
+rcode slotmap_remove(Slotmap *m, slot_handle handle) {
+	if (!m) return DESCENT_ERROR_NULL;
+
+	SlotmapSlot *slot = slotmap_slot(m, handle);
+	if (!slot) return DESCENT_ERROR_INVALID;
+
+	uint32_t index = (uint32_t) (handle & SLOT_INDEX_MASK);
+	uint32_t dense = slot->dense;
+	size_t last = varray_count(&m->_dense) - 1;
+
+	// Move the last element into the hole
+	if (dense != last) {
+		uint32_t owner = *(uint32_t *) varray_at(&m->_owners, last);
+		memcpy(varray_at(&m->_dense, dense), varray_at(&m->_dense, last), m->_dense._element_size);
+		*(uint32_t *) varray_at(&m->_owners, dense) = owner;
+		((SlotmapSlot *) varray_at(&m->_slots, owner))->dense = dense;
+	}
+
+	varray_pop(&m->_dense, NULL);
+	varray_pop(&m->_owners, NULL);
+
+	// Invalidate outstanding handles, skipping the reserved generation 0
+	uint32_t generation = (slot->generation + 1) & SLOT_GENERATION_MASK;
+	slot->generation = generation ? generation : 1;
+	slot->dense = m->_free;
+	m->_free = index;
+
+	return 0;
+}
+
+slot_handle slotmap_handle_at(const Slotmap *m, size_t index) {
+	if (!m) return SLOT_HANDLE_NONE;
+
+	uint32_t *owner = varray_at(&m->_owners, index);
+	if (!owner) return SLOT_HANDLE_NONE;
+
+	const SlotmapSlot *slot = varray_at(&m->_slots, *owner);
+	return slot_handle_make(*owner, slot->generation);
+}
@@ -0,0 +1,142 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/alloc/stackalloc.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+#include <descent/utilities/builtin.h>
+#include <descent/utilities/macros.h>
+#include <intern/thread/job.h>
+#include <intern/thread/thread.h>
+#include <intern/thread/tid.h>
+
+// Each slot is only ever touched by the thread holding its thread ID
+static Stackalloc thread_stacks[THREAD_MAX] = {0};
+
+#if DESCENT_JOB_FIBERS
+// A job may resume on another thread after job_wait(), and other jobs run on
+// its thread meanwhile, so jobs on fibers use their fiber's slot instead. Each
+// slot is only ever touched by the job running on its fiber.
+static Stackalloc fiber_stacks[DESCENT_JOB_FIBER_COUNT] = {0};
+#endif
+
+_Static_assert(DESCENT_STACKALLOC_COMMIT_STEP && !(DESCENT_STACKALLOC_COMMIT_STEP & (DESCENT_STACKALLOC_COMMIT_STEP - 1)), "Stack allocator commit step must be a power of two");
+
+static inline size_t round_to_granularity(size_t size, size_t granularity) {
+	return (size + granularity - 1) & ~(granularity - 1);
+}
+
+rcode stackalloc_init(Stackalloc *s, size_t size) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	memset(s, 0, sizeof(*s));
+
+	s->_reservation.size = size;
+	return sysalloc_reserve(&s->_reservation);
+}
+
+rcode stackalloc_release(Stackalloc *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	rcode result = 0;
+	if (s->_reservation.base) result = sysfree(&s->_reservation);
+
+	memset(s, 0, sizeof(*s));
+	return result;
+}
+
+rcode stackalloc(Stackalloc *s, size_t size, size_t align, void **out) {
+	if (!s || !out) return DESCENT_ERROR_NULL;
+	if (!align || (align & (align - 1))) return DESCENT_ERROR_INVALID;
+
+	// The address is aligned rather than the offset, since the reservation is
+	// only aligned to the granularity
+	uintptr_t base = (uintptr_t) s->_reservation.base;
+	uintptr_t top = base + s->_top;
+	uintptr_t aligned = (top + align - 1) & ~((uintptr_t) align - 1);
+	if (aligned < top) return DESCENT_ERROR_OVERFLOW;
+
+	size_t start = (size_t) (aligned - base);
+	if (start > s->_reservation.size || size > s->_reservation.size - start) return DESCENT_ERROR_OVERFLOW;
+
+	size_t end = start + size;
+	if (end > s->_committed) {
+		size_t granularity = sysalloc_granularity();
+		if (!granularity) return DESCENT_ERROR_OS;
+
+		size_t step = round_to_granularity(DESCENT_STACKALLOC_COMMIT_STEP, granularity);
+		size_t target = round_to_granularity(end, step);
+		if (target > s->_reservation.size) target = s->_reservation.size;
+
+		rcode result = sysalloc_commit(&s->_reservation, s->_committed, target - s->_committed, SYSALLOC_ACCESS_READ_WRITE);
+		if (result) return result;
+
+		s->_committed = target;
+	}
+
+	s->_top = end;
+	*out = POINTER_OFFSET(void, s->_reservation.base, start);
+	return 0;
+}
+
+rcode stackalloc_pop(Stackalloc *s, StackallocMarker marker) {
+	if (!s) return DESCENT_ERROR_NULL;
+	if (marker > s->_top) return DESCENT_ERROR_INVALID;
+
+	s->_top = marker;
+	return 0;
+}
+
+rcode stackalloc_trim(Stackalloc *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+
+	size_t keep = round_to_granularity(s->_top, granularity);
+	if (keep >= s->_committed) return 0;
+
+	rcode result = sysalloc_decommit(&s->_reservation, keep, s->_committed - keep);
+	if (result) return result;
+
+	s->_committed = keep;
+	return 0;
+}
+
+rcode stackalloc_self(Stackalloc **s) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	unsigned int index = tid_index(tid_self());
+	if (builtin_expect(index >= THREAD_MAX, false)) return DESCENT_ERROR_FORBIDDEN;
+
+	Stackalloc *stack = &thread_stacks[index];
+#if DESCENT_JOB_FIBERS
+	unsigned int fiber = job_fiber_self();
+	if (fiber) stack = &fiber_stacks[fiber - 1];
+#endif
+	if (builtin_expect(!stack->_reservation.base, false)) {
+		rcode result = stackalloc_init(stack, DESCENT_STACKALLOC_THREAD_SIZE);
+		if (result) return result;
+	}
+
+	*s = stack;
+	return 0;
+}
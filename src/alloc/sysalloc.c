@@ -407,4 +407,4 @@ rcode sysfree(Sysalloc *s) {
 // void *
 
 
-// TODO: Swapping to disk
+// Swapping to disk is provided by file-backed spill arenas in the file module
@@ -0,0 +1,143 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/alloc/varray.h>
+
+#include <stddef.h>
+#include <string.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+#include <descent/utilities/macros.h>
+
+_Static_assert(DESCENT_VARRAY_COMMIT_STEP && !(DESCENT_VARRAY_COMMIT_STEP & (DESCENT_VARRAY_COMMIT_STEP - 1)), "Virtual array commit step must be a power of two");
+
+static inline size_t round_to_granularity(size_t size, size_t granularity) {
+	return (size + granularity - 1) & ~(granularity - 1);
+}
+
+static rcode varray_commit(VArray *v, size_t count) {
+	size_t bytes = count * v->_element_size;
+	if (bytes <= v->_committed) return 0;
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+
+	// Commit in large steps to keep the number of system calls down
+	size_t step = round_to_granularity(DESCENT_VARRAY_COMMIT_STEP, granularity);
+	size_t target = round_to_granularity(bytes, step);
+	if (target > v->_reservation.size) target = v->_reservation.size;
+
+	rcode result = sysalloc_commit(&v->_reservation, v->_committed, target - v->_committed, SYSALLOC_ACCESS_READ_WRITE);
+	if (result) return result;
+
+	v->_committed = target;
+	return 0;
+}
+
+rcode varray_init(VArray *v, size_t element_size, size_t capacity) {
+	if (!v) return DESCENT_ERROR_NULL;
+
+	memset(v, 0, sizeof(*v));
+
+	if (!element_size || !capacity) return DESCENT_ERROR_INVALID;
+	if (capacity > DESCENT_MAX_ALLOC / element_size) return DESCENT_ERROR_OVERFLOW;
+
+	v->_reservation.size = element_size * capacity;
+	rcode result = sysalloc_reserve(&v->_reservation);
+	if (result) return result;
+
+	v->_element_size = element_size;
+	v->_capacity = capacity;
+	return 0;
+}
+
+rcode varray_release(VArray *v) {
+	if (!v) return DESCENT_ERROR_NULL;
+
+	rcode result = 0;
+	if (v->_reservation.base) result = sysfree(&v->_reservation);
+
+	memset(v, 0, sizeof(*v));
+	return result;
+}
+
+rcode varray_reserve(VArray *v, size_t count) {
+	if (!v) return DESCENT_ERROR_NULL;
+	if (count > v->_capacity) return DESCENT_ERROR_OVERFLOW;
+
+	return varray_commit(v, count);
+}
+
+rcode varray_resize(VArray *v, size_t count) {
+	if (!v) return DESCENT_ERROR_NULL;
+	if (count > v->_capacity) return DESCENT_ERROR_OVERFLOW;
+
+	if (count > v->_count) {
+		rcode result = varray_commit(v, count);
+		if (result) return result;
+
+		void *first = POINTER_OFFSET(void, v->_reservation.base, v->_count * v->_element_size);
+		memset(first, 0, (count - v->_count) * v->_element_size);
+	}
+
+	v->_count = count;
+	return 0;
+}
+
+rcode varray_push(VArray *v, size_t count, const void *elements, void **first) {
+	if (!v) return DESCENT_ERROR_NULL;
+	if (count > v->_capacity - v->_count) return DESCENT_ERROR_OVERFLOW;
+
+	rcode result = varray_commit(v, v->_count + count);
+	if (result) return result;
+
+	void *start = POINTER_OFFSET(void, v->_reservation.base, v->_count * v->_element_size);
+	if (elements) memcpy(start, elements, count * v->_element_size);
+	else memset(start, 0, count * v->_element_size);
+
+	v->_count += count;
+	if (first) *first = start;
+	return 0;
+}
+
+rcode varray_pop(VArray *v, void *element) {
+	if (!v) return DESCENT_ERROR_NULL;
+	if (!v->_count) return DESCENT_ERROR_STATE;
+
+	--v->_count;
+	if (element) {
+		void *last = POINTER_OFFSET(void, v->_reservation.base, v->_count * v->_element_size);
+		memcpy(element, last, v->_element_size);
+	}
+
+	return 0;
+}
+
+rcode varray_shrink(VArray *v) {
+	if (!v) return DESCENT_ERROR_NULL;
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+
+	size_t keep = round_to_granularity(v->_count * v->_element_size, granularity);
+	if (keep >= v->_committed) return 0;
+
+	rcode result = sysalloc_decommit(&v->_reservation, keep, v->_committed - keep);
+	if (result) return result;
+
+	v->_committed = keep;
+	return 0;
+}
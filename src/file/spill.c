@@ -0,0 +1,242 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/utilities/platform.h>
+#if defined(DESCENT_PLATFORM_LINUX)
+#define _GNU_SOURCE
+#endif
+
+#include <descent/file/spill.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/file.h>
+#include <descent/rcode.h>
+#include <descent/utilities/macros.h>
+
+#include "path.h"
+#include "file/handle.h"
+
+// "DSPILL" followed by a format version
+#define SPILL_MAGIC 0x00014C4C49505344ull
+
+// The header is padded so that allocations can be cache-line aligned
+#define SPILL_HEADER_SIZE 64u
+
+typedef struct {
+	uint64_t magic;
+	uint64_t size;
+	uint64_t top;
+} SpillHeader;
+
+static inline SpillHeader *spill_header(SpillArena *s) {
+	return (SpillHeader *) s->_base;
+}
+
+static inline int spill_map(SpillArena *s, size_t size) {
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+
+	int fd = (int) s->_handle;
+
+	struct stat st;
+	if (fstat(fd, &st)) return DESCENT_ERROR_OS;
+
+	// The file is extended sparsely, so untouched pages use no disk space
+	if ((uint64_t) st.st_size < (uint64_t) size && ftruncate(fd, (off_t) size)) {
+		switch (errno) {
+			case EFBIG:
+			case ENOSPC:
+				return FILE_ERROR_NO_SPACE;
+			case EACCES:
+			case EPERM:
+			case EROFS:
+				return DESCENT_ERROR_FORBIDDEN;
+			default:
+				return DESCENT_ERROR_OS;
+		}
+	}
+
+	void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		switch (errno) {
+			case ENOMEM:
+			case EOVERFLOW:
+				return DESCENT_ERROR_MEMORY;
+			case EACCES:
+				return DESCENT_ERROR_FORBIDDEN;
+			default:
+				return DESCENT_ERROR_OS;
+		}
+	}
+
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+
+	// Mapping more than the file size extends the file
+	uint64_t size_64 = (uint64_t) size;
+	HANDLE mapping = CreateFileMappingW((HANDLE) s->_handle, NULL, PAGE_READWRITE, (DWORD) (size_64 >> 32), (DWORD) size_64, NULL);
+	if (!mapping) {
+		switch (GetLastError()) {
+			case ERROR_DISK_FULL:
+				return FILE_ERROR_NO_SPACE;
+			case ERROR_ACCESS_DENIED:
+				return DESCENT_ERROR_FORBIDDEN;
+			default:
+				return DESCENT_ERROR_OS;
+		}
+	}
+
+	void *base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!base) {
+		CloseHandle(mapping);
+		return GetLastError() == ERROR_NOT_ENOUGH_MEMORY ? DESCENT_ERROR_MEMORY : DESCENT_ERROR_OS;
+	}
+
+	s->_mapping = (uintptr_t) mapping;
+
+#endif
+
+	s->_base = base;
+	s->_size = size;
+	return 0;
+}
+
+static inline int spill_unmap(SpillArena *s) {
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+	if (munmap(s->_base, s->_size)) return DESCENT_ERROR_OS;
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+	if (!UnmapViewOfFile(s->_base)) return DESCENT_ERROR_OS;
+	if (!CloseHandle((HANDLE) s->_mapping)) return DESCENT_ERROR_OS;
+#endif
+	return 0;
+}
+
+int spill_open(SpillArena *s, const char *dpath, size_t size, int mode) {
+	if (!s || !dpath) return DESCENT_ERROR_NULL;
+
+	memset(s, 0, sizeof(*s));
+
+	if (mode & ~SPILL_MODE_PERSIST) return DESCENT_ERROR_INVALID;
+	if (size <= SPILL_HEADER_SIZE) return DESCENT_ERROR_INVALID;
+	if (size > DESCENT_MAX_ALLOC) return DESCENT_ERROR_OVERFLOW;
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+	size = (size + granularity - 1) & ~(granularity - 1);
+
+	Path path = {0};
+	int result = path_resolve_dpath(&path, dpath);
+	if (result) return result;
+
+	int file_mode = FILE_MODE_READ | FILE_MODE_WRITE | FILE_MODE_CREATE;
+	if (!(mode & SPILL_MODE_PERSIST)) file_mode |= FILE_MODE_TRUNCATE;
+
+	result = file_open_handle(&s->_handle, &path, file_mode);
+	if (result) return result;
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+	// The open descriptor keeps an unlinked file alive until it is closed
+	if (!(mode & SPILL_MODE_PERSIST)) unlink(path.string);
+#endif
+
+	result = spill_map(s, size);
+	if (result) {
+		file_close_handle(s->_handle);
+		memset(s, 0, sizeof(*s));
+		return result;
+	}
+
+	// Keep the contents of a valid persistent arena. Files are never shrunk,
+	// so one reopened with a smaller size is refused while still intact.
+	SpillHeader *header = spill_header(s);
+	int valid = header->magic == SPILL_MAGIC && header->top <= header->size;
+	if ((mode & SPILL_MODE_PERSIST) && valid && header->size > size) {
+		spill_unmap(s);
+		file_close_handle(s->_handle);
+		memset(s, 0, sizeof(*s));
+		return DESCENT_ERROR_INVALID;
+	}
+
+	if (!(mode & SPILL_MODE_PERSIST) || !valid) {
+		header->magic = SPILL_MAGIC;
+		header->top = SPILL_HEADER_SIZE;
+	}
+	header->size = size;
+
+	return 0;
+}
+
+int spill_close(SpillArena *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+	if (!s->_base) return DESCENT_ERROR_STATE;
+
+	int result = spill_unmap(s);
+	if (result) return result;
+
+	result = file_close_handle(s->_handle);
+	memset(s, 0, sizeof(*s));
+	return result;
+}
+
+int spill_alloc(SpillArena *s, size_t size, size_t align, void **out) {
+	if (!s || !out) return DESCENT_ERROR_NULL;
+	if (!s->_base) return DESCENT_ERROR_STATE;
+	if (!align || (align & (align - 1))) return DESCENT_ERROR_INVALID;
+
+	SpillHeader *header = spill_header(s);
+
+	size_t start = ((size_t) header->top + align - 1) & ~(align - 1);
+	if (start < header->top || start > s->_size || size > s->_size - start) {
+		return DESCENT_ERROR_OVERFLOW;
+	}
+
+	header->top = start + size;
+	*out = POINTER_OFFSET(void, s->_base, start);
+	return 0;
+}
+
+int spill_reset(SpillArena *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+	if (!s->_base) return DESCENT_ERROR_STATE;
+
+	spill_header(s)->top = SPILL_HEADER_SIZE;
+	return 0;
+}
+
+int spill_sync(SpillArena *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+	if (!s->_base) return DESCENT_ERROR_STATE;
+
+#if defined(DESCENT_PLATFORM_TYPE_POSIX)
+	if (msync(s->_base, s->_size, MS_SYNC)) return DESCENT_ERROR_OS;
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+	if (!FlushViewOfFile(s->_base, 0)) return DESCENT_ERROR_OS;
+	if (!FlushFileBuffers((HANDLE) s->_handle)) return DESCENT_ERROR_OS;
+#endif
+
+	return 0;
+}
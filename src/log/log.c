@@ -33,8 +33,9 @@
 
 #include <descent/modules.h>
 #include <descent/thread/atomic.h>
+#include <descent/thread/call_once.h>
+#include <descent/thread/queue.h>
 #include <descent/thread/rwlock.h>
-#include <descent/thread/thread.h>
 #include <descent/utilities/intrin/bits.h>
 #include <descent/rcode.h>
 
@@ -65,7 +66,6 @@ typedef struct {
 	time_t timestamp;
 	int module;
 	int level;
-	atomic_32 complete;
 } LogMessage;
 
 // Global variables
@@ -74,9 +74,23 @@ static LogSink log_sinks[MODULE_COUNT][LOG_MODULE_SINK_COUNT] = {0};
 static RWLock log_sink_lock;
 static RWLock submit_lock;
 
-static atomic_32 queue_head = 0;
-static atomic_32 queue_tail = 0;
-static LogMessage queue[LOG_QUEUE_SIZE] = {0};
+// Every message is always in exactly one of the queues, so pushes never fail
+static LogMessage log_messages[LOG_QUEUE_SIZE] = {0};
+static struct QueueCell log_free_cells[LOG_QUEUE_SIZE];
+static struct QueueCell log_pending_cells[LOG_QUEUE_SIZE];
+static struct Queue log_free;    // Messages available to submitters
+static struct Queue log_pending; // Messages waiting to be written
+static struct CallOnce log_queue_once = CALL_ONCE_INIT;
+
+// Submitters blocked until a message is freed
+static atomic_32 log_free_waiters = ATOMIC_INIT(0);
+
+static void log_queue_init(void) {
+	queue_init(&log_free, log_free_cells, LOG_QUEUE_SIZE);
+	queue_init(&log_pending, log_pending_cells, LOG_QUEUE_SIZE);
+
+	for (int i = 0; i < LOG_QUEUE_SIZE; ++i) queue_trypush(&log_free, &log_messages[i]);
+}
 
 // Validity Helpers
 
@@ -338,29 +352,27 @@ int log_submit(DescentModule m, LogLevel l, const char *fmt, va_list args) {
 	if (!log_levels_valid(l)) return LOG_ERROR_INVALID_LEVEL;
 	if (!fmt) return DESCENT_ERROR_NULL;
 
+	call_once(&log_queue_once, log_queue_init);
+
 	rwlock_read_lock(&submit_lock);
 
-	// Claim a message index using a CAS loop
-	// this loop may be overcontentious.
-	uint32_t index;
-	do {
-		uint32_t tail = atomic_load_32(&queue_tail);
-		uint32_t head = atomic_load_32(&queue_head);
-
-		if ((tail - head) >= LOG_QUEUE_SIZE) {
-			// Become a writer to free queue space, then retry
-			// This is necessary if the caller has not set up a dedicated writer
-			log_write();
-			continue;
-		}
+	// Become a writer to free a message, then block until one is free
+	// This is necessary if the caller has not set up a dedicated writer
+	void *slot;
+	if (queue_trypop(&log_free, &slot)) {
+		atomic_fetch_add_32(&log_free_waiters, 1, ATOMIC_SEQ_CST);
+		log_write();
 
-		index = tail;
-	} while (!atomic_compare_exchange_32(&queue_tail, &index, index + 1));
+		int pop_result = queue_pop(&log_free, &slot);
+		atomic_fetch_sub_32(&log_free_waiters, 1, ATOMIC_RELAXED);
 
-	LogMessage *msg = &queue[index % LOG_QUEUE_SIZE];
+		if (pop_result) {
+			rwlock_read_unlock(&submit_lock);
+			return pop_result;
+		}
+	}
 
-	// this loop may be overcontentious.
-	while (atomic_load_32(&msg->complete) == 1) thread_yield();
+	LogMessage *msg = slot;
 
 	msg->timestamp = time(NULL);
 	msg->module = m;
@@ -377,30 +389,26 @@ int log_submit(DescentModule m, LogLevel l, const char *fmt, va_list args) {
 		result = 0;
 	}
 
-	atomic_store_32(&msg->complete, 1);
+	queue_trypush(&log_pending, msg);
+
+	// A blocked submitter may have found nothing pending to write, if every
+	// message was still being filled in, so a message is written for it
+	if (atomic_load_32(&log_free_waiters, ATOMIC_SEQ_CST)) log_write();
 	
 	rwlock_read_unlock(&submit_lock);
 	
 	return result;
 }
 
-void log_write(void) {
-	// Claim a message index using a CAS loop
-	uint32_t index;
-	do {
-		uint32_t tail = atomic_load_32(&queue_tail);
-		uint32_t head = atomic_load_32(&queue_head);
-
-		if (tail == head) return;
+// Writes the oldest pending message, if any
+static int log_write_next(void) {
+	call_once(&log_queue_once, log_queue_init);
 
-		index = head;
-	} while (!atomic_compare_exchange_32(&queue_head, &index, index + 1));
+	// Messages are only pending once they are complete
+	void *slot;
+	if (queue_trypop(&log_pending, &slot)) return 0;
 
-	// Load the message
-	LogMessage *msg = &queue[index % LOG_QUEUE_SIZE];
-
-	// Wait to write the message until it is complete
-	while (atomic_load_32(&msg->complete) == 0) thread_yield();
+	LogMessage *msg = slot;
 
 	// Load parameters from the log message
 	int module = msg->module;
@@ -457,15 +465,18 @@ void log_write(void) {
 
 	rwlock_read_unlock(&log_sink_lock);
 
-	atomic_store_32(&msg->complete, 0);
+	queue_trypush(&log_free, msg);
+	return 1;
+}
+
+void log_write(void) {
+	log_write_next();
 }
 
 void log_close(void) {
 	rwlock_write_lock(&submit_lock);
 
-	while (atomic_load_32(&queue_head) != atomic_load_32(&queue_tail)) {
-		log_write();
-	}
+	while (log_write_next());
 
 	for (int i = 0; i < MODULE_COUNT; ++i) {
 		for (int j = 0; j < LOG_MODULE_SINK_COUNT; ++j) {
@@ -0,0 +1,268 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/script/alloc.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+#include <descent/utilities/macros.h>
+
+// Blocks are aligned to 16 bytes, which satisfies the maximum alignment Lua
+// requires on every supported platform
+#define SCRIPT_ALLOC_ALIGN 16u
+
+// Classes step by 16 bytes up to 128, then by four steps per power of two
+#define SCRIPT_ALLOC_FINE_MAX 128u
+#define SCRIPT_ALLOC_CLASS_MAX 2048u
+
+// Large blocks are prefixed with the size of their mapping
+#define SCRIPT_ALLOC_HEADER SCRIPT_ALLOC_ALIGN
+
+static inline size_t class_size(unsigned c) {
+	if (c < 8) return (size_t) (c + 1) * 16u;
+	unsigned group = (c - 8) / 4;
+	unsigned step = (c - 8) % 4;
+	return (size_t) (5 + step) << (group + 5);
+}
+
+// size must be in [1, SCRIPT_ALLOC_CLASS_MAX]
+static inline unsigned class_index(size_t size) {
+	if (size <= SCRIPT_ALLOC_FINE_MAX) return (unsigned) ((size + 15) / 16 - 1);
+
+	size_t last = size - 1;
+	unsigned log2 = 7;
+	while (last >> (log2 + 1)) ++log2;
+
+	return 8 + (log2 - 7) * 4 + (unsigned) (last >> (log2 - 2)) - 4;
+}
+
+static inline int is_pooled(const ScriptAllocator *a, const void *ptr) {
+	uintptr_t base = (uintptr_t) a->_pool.base;
+	uintptr_t address = (uintptr_t) ptr;
+	return address >= base && address - base < a->_pool.size;
+}
+
+static inline void push_free(ScriptAllocator *a, unsigned c, void *block) {
+	*(void **) block = a->_free[c];
+	a->_free[c] = block;
+}
+
+// Returns the tail of a block to the free lists, largest classes first
+static void split_free(ScriptAllocator *a, void *tail, size_t size) {
+	unsigned c = SCRIPT_ALLOC_CLASS_COUNT;
+	while (size) {
+		while (class_size(c - 1) > size) --c;
+		size_t block = class_size(c - 1);
+		push_free(a, c - 1, tail);
+		tail = POINTER_OFFSET(void, tail, block);
+		size -= block;
+	}
+}
+
+static int pool_grow(ScriptAllocator *a, size_t needed) {
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return 0;
+
+	size_t step = (DESCENT_SCRIPT_ALLOC_CHUNK + granularity - 1) & ~(granularity - 1);
+	size_t remaining = a->_pool.size - a->_committed;
+	if (step > remaining) step = remaining;
+	if (step > a->_limit - a->_footprint) step = (a->_limit - a->_footprint) & ~(granularity - 1);
+
+	// The pool is contiguous, so the uncarved end of the previous chunk is kept
+	if (a->_top + needed > a->_committed + step) return 0;
+
+	if (sysalloc_commit(&a->_pool, a->_committed, step, SYSALLOC_ACCESS_READ_WRITE)) return 0;
+
+	a->_committed += step;
+	a->_footprint += step;
+	return 1;
+}
+
+static void *pool_alloc(ScriptAllocator *a, unsigned c) {
+	size_t size = class_size(c);
+
+	void *block = a->_free[c];
+	if (block) {
+		a->_free[c] = *(void **) block;
+		a->_used += size;
+		return block;
+	}
+
+	if (a->_top + size <= a->_committed || pool_grow(a, size)) {
+		block = POINTER_OFFSET(void, a->_pool.base, a->_top);
+		a->_top += size;
+		a->_used += size;
+		return block;
+	}
+
+	// At the limit, so split a free block of a larger class
+	for (unsigned larger = c + 1; larger < SCRIPT_ALLOC_CLASS_COUNT; ++larger) {
+		block = a->_free[larger];
+		if (!block) continue;
+
+		a->_free[larger] = *(void **) block;
+		split_free(a, POINTER_OFFSET(void, block, size), class_size(larger) - size);
+		a->_used += size;
+		return block;
+	}
+
+	return NULL;
+}
+
+static inline void pool_free(ScriptAllocator *a, void *ptr, unsigned c) {
+	push_free(a, c, ptr);
+	a->_used -= class_size(c);
+}
+
+static void *large_alloc(ScriptAllocator *a, size_t size) {
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return NULL;
+
+	if (size > DESCENT_MAX_ALLOC - SCRIPT_ALLOC_HEADER - granularity) return NULL;
+
+	// Check the limit before mapping anything
+	size_t map_size = (size + SCRIPT_ALLOC_HEADER + granularity - 1) & ~(granularity - 1);
+	if (map_size > a->_limit - a->_footprint) return NULL;
+
+	Sysalloc s = {.size = map_size};
+	if (sysalloc(&s, SYSALLOC_ACCESS_READ_WRITE)) return NULL;
+
+	*(size_t *) s.base = s.size;
+	a->_footprint += s.size;
+	a->_used += s.size;
+
+	return POINTER_OFFSET(void, s.base, SCRIPT_ALLOC_HEADER);
+}
+
+static inline size_t large_capacity(const void *ptr) {
+	return *(const size_t *) ((const char *) ptr - SCRIPT_ALLOC_HEADER) - SCRIPT_ALLOC_HEADER;
+}
+
+static void large_free(ScriptAllocator *a, void *ptr) {
+	void *base = (char *) ptr - SCRIPT_ALLOC_HEADER;
+	Sysalloc s = {.base = base, .size = *(size_t *) base};
+
+	a->_footprint -= s.size;
+	a->_used -= s.size;
+	sysfree(&s);
+}
+
+static void *block_alloc(ScriptAllocator *a, size_t size) {
+	if (size <= SCRIPT_ALLOC_CLASS_MAX) return pool_alloc(a, class_index(size));
+	return large_alloc(a, size);
+}
+
+static void block_free(ScriptAllocator *a, void *ptr, size_t size) {
+	if (is_pooled(a, ptr)) pool_free(a, ptr, class_index(size));
+	else large_free(a, ptr);
+}
+
+rcode script_allocator_init(ScriptAllocator *a, size_t limit) {
+	if (!a) return DESCENT_ERROR_NULL;
+
+	memset(a, 0, sizeof(*a));
+
+	if (!limit) limit = DESCENT_SCRIPT_ALLOC_LIMIT;
+	if (limit > DESCENT_MAX_ALLOC) limit = DESCENT_MAX_ALLOC;
+
+	// Large blocks count against the limit too, so the pool never needs more
+	a->_pool.size = limit;
+	rcode result = sysalloc_reserve(&a->_pool);
+	if (result) return result;
+
+	a->_limit = limit;
+	return 0;
+}
+
+rcode script_allocator_release(ScriptAllocator *a) {
+	if (!a) return DESCENT_ERROR_NULL;
+
+	// Large blocks cannot be found without Lua's help, so they must have been
+	// freed by closing every state
+	rcode result = 0;
+	if (a->_pool.base) result = sysfree(&a->_pool);
+
+	memset(a, 0, sizeof(*a));
+	return result;
+}
+
+void *script_allocator_lua(void *ud, void *ptr, size_t osize, size_t nsize) {
+	ScriptAllocator *a = ud;
+	if (!a) return NULL;
+
+	// Lua passes the object type in osize when ptr is NULL
+	if (!ptr) return nsize ? block_alloc(a, nsize) : NULL;
+
+	if (!nsize) {
+		block_free(a, ptr, osize);
+		return NULL;
+	}
+
+	if (is_pooled(a, ptr)) {
+		unsigned old_class = class_index(osize);
+
+		if (nsize <= SCRIPT_ALLOC_CLASS_MAX) {
+			unsigned new_class = class_index(nsize);
+			if (new_class == old_class) return ptr;
+
+			// Shrink in place so that it cannot fail
+			if (new_class < old_class) {
+				size_t keep = class_size(new_class);
+				split_free(a, POINTER_OFFSET(void, ptr, keep), class_size(old_class) - keep);
+				a->_used -= class_size(old_class) - keep;
+				return ptr;
+			}
+		}
+
+		void *moved = block_alloc(a, nsize);
+		if (!moved) return NULL;
+
+		memcpy(moved, ptr, osize);
+		pool_free(a, ptr, old_class);
+		return moved;
+	}
+
+	size_t capacity = large_capacity(ptr);
+	if (nsize <= capacity) {
+		if (nsize > SCRIPT_ALLOC_CLASS_MAX) return ptr;
+
+		// Move shrunken blocks into the pool if possible, otherwise keep them
+		void *moved = pool_alloc(a, class_index(nsize));
+		if (!moved) return ptr;
+
+		memcpy(moved, ptr, nsize);
+		large_free(a, ptr);
+		return moved;
+	}
+
+	void *moved = large_alloc(a, nsize);
+	if (!moved) return NULL;
+
+	memcpy(moved, ptr, osize < capacity ? osize : capacity);
+	large_free(a, ptr);
+	return moved;
+}
+
+size_t script_allocator_used(const ScriptAllocator *a) {
+	return a ? a->_used : 0;
+}
+
+size_t script_allocator_footprint(const ScriptAllocator *a) {
+	return a ? a->_footprint : 0;
+}
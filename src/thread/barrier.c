@@ -0,0 +1,84 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/barrier.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <intern/thread/hints.h>
+#include <intern/thread/spin.h>
+
+// Spins while the phase is likely to end soon
+static bool barrier_spin(struct Barrier *b, uint32_t generation) {
+	uint32_t limit = spin_limit(&b->_spin);
+
+	for (uint32_t spins = 0; spins < limit; ++spins) {
+		thread_spin_hint();
+
+		if (atomic_load_32(&b->_generation, ATOMIC_ACQUIRE) != generation) {
+			spin_learn(&b->_spin, spins, true);
+			return true;
+		}
+	}
+
+	spin_learn(&b->_spin, limit, false);
+	return false;
+}
+
+rcode barrier_init(struct Barrier *b, unsigned int count, void (*completion)(void *), void *argument) {
+	if (!b) return DESCENT_ERROR_NULL;
+	if (!count) return DESCENT_ERROR_INVALID;
+
+	*b = (struct Barrier) BARRIER_INIT_COMPLETION(count, completion, argument);
+
+	return 0;
+}
+
+rcode barrier_wait(struct Barrier *b) {
+	if (!b) return DESCENT_ERROR_NULL;
+
+	uint32_t generation = atomic_load_32(&b->_generation, ATOMIC_ACQUIRE);
+
+	if (atomic_add_fetch_32(&b->_arrived, 1, ATOMIC_ACQ_REL) == b->_count) {
+		if (b->_completion) b->_completion(b->_argument);
+
+		// Threads only arrive at the next phase after seeing the generation
+		// change, so the count can be reset first
+		atomic_store_32(&b->_arrived, 0, ATOMIC_RELAXED);
+		atomic_add_fetch_32(&b->_generation, 1, ATOMIC_SEQ_CST);
+
+		if (atomic_load_32(&b->_parked, ATOMIC_SEQ_CST)) return futex_wake_all(&b->_generation);
+		return 0;
+	}
+
+	if (barrier_spin(b, generation)) return 0;
+
+	while (atomic_load_32(&b->_generation, ATOMIC_ACQUIRE) == generation) {
+		// Counted before the final check, so the releasing thread either sees
+		// this thread parked or this thread sees the new generation
+		atomic_fetch_add_32(&b->_parked, 1, ATOMIC_SEQ_CST);
+		rcode result = futex_wait(&b->_generation, generation);
+		atomic_fetch_sub_32(&b->_parked, 1, ATOMIC_RELAXED);
+
+		if (result) return result;
+	}
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/channel.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+
+#define CHANNEL_SLEEPING_CONSUMER 1u
+#define CHANNEL_SLEEPING_PRODUCER 2u
+
+rcode channel_init(struct Channel *c, void *buffer, size_t size, size_t capacity, bool doorbell) {
+	if (!c || !buffer) return DESCENT_ERROR_NULL;
+	if (!size || !capacity || (capacity & (capacity - 1))) return DESCENT_ERROR_INVALID;
+
+	atomic_store_64(&c->_tail, 0, ATOMIC_RELAXED);
+	atomic_store_64(&c->_head, 0, ATOMIC_RELAXED);
+	c->_head_cache = 0;
+	c->_tail_cache = 0;
+	atomic_store_32(&c->_bell, 0, ATOMIC_RELAXED);
+	atomic_store_32(&c->_sleeping, 0, ATOMIC_RELAXED);
+	c->_buffer = buffer;
+	c->_size = size;
+	c->_mask = (uint64_t) capacity - 1;
+	c->_doorbell = doorbell;
+
+	atomic_thread_fence(ATOMIC_RELEASE);
+	return 0;
+}
+
+// Wakes the other side if it sleeps
+static inline void channel_ring(struct Channel *c, uint32_t side) {
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	if (!(atomic_load_32(&c->_sleeping, ATOMIC_RELAXED) & side)) return;
+
+	atomic_fetch_add_32(&c->_bell, 1, ATOMIC_RELEASE);
+	futex_wake_all(&c->_bell);
+}
+
+// Copies between the ring and a linear array, splitting at the wrap point
+static inline void channel_copy(struct Channel *c, uint64_t position, void *messages, size_t count, bool into) {
+	size_t capacity = (size_t) c->_mask + 1;
+	size_t index = (size_t) (position & c->_mask);
+	size_t first = capacity - index < count ? capacity - index : count;
+
+	unsigned char *ring = c->_buffer + index * c->_size;
+	unsigned char *linear = messages;
+
+	if (into) {
+		memcpy(ring, linear, first * c->_size);
+		memcpy(c->_buffer, linear + first * c->_size, (count - first) * c->_size);
+	} else {
+		memcpy(linear, ring, first * c->_size);
+		memcpy(linear + first * c->_size, c->_buffer, (count - first) * c->_size);
+	}
+}
+
+size_t channel_push(struct Channel *c, const void *messages, size_t count) {
+	if (!c || !messages || !count) return 0;
+
+	uint64_t capacity = c->_mask + 1;
+	uint64_t tail = atomic_load_64(&c->_tail, ATOMIC_RELAXED);
+	uint64_t free = capacity - (tail - c->_head_cache);
+
+	// Only reread the consumer's position when the cached one is too old
+	if (free < count) {
+		c->_head_cache = atomic_load_64(&c->_head, ATOMIC_ACQUIRE);
+		free = capacity - (tail - c->_head_cache);
+	}
+
+	size_t n = free < count ? (size_t) free : count;
+	if (!n) return 0;
+
+	channel_copy(c, tail, (void *) (uintptr_t) messages, n, true);
+	atomic_store_64(&c->_tail, tail + n, ATOMIC_RELEASE);
+
+	if (c->_doorbell) channel_ring(c, CHANNEL_SLEEPING_CONSUMER);
+	return n;
+}
+
+size_t channel_pop(struct Channel *c, void *messages, size_t count) {
+	if (!c || !messages || !count) return 0;
+
+	uint64_t head = atomic_load_64(&c->_head, ATOMIC_RELAXED);
+	uint64_t filled = c->_tail_cache - head;
+
+	// Only reread the producer's position when the cached one is too old
+	if (filled < count) {
+		c->_tail_cache = atomic_load_64(&c->_tail, ATOMIC_ACQUIRE);
+		filled = c->_tail_cache - head;
+	}
+
+	size_t n = filled < count ? (size_t) filled : count;
+	if (!n) return 0;
+
+	channel_copy(c, head, messages, n, false);
+	atomic_store_64(&c->_head, head + n, ATOMIC_RELEASE);
+
+	if (c->_doorbell) channel_ring(c, CHANNEL_SLEEPING_PRODUCER);
+	return n;
+}
+
+// Checks whether the other side has made room or sent messages
+static inline bool channel_ready(struct Channel *c, uint32_t side) {
+	if (side == CHANNEL_SLEEPING_CONSUMER) {
+		c->_tail_cache = atomic_load_64(&c->_tail, ATOMIC_ACQUIRE);
+		return c->_tail_cache != atomic_load_64(&c->_head, ATOMIC_RELAXED);
+	}
+
+	c->_head_cache = atomic_load_64(&c->_head, ATOMIC_ACQUIRE);
+	return atomic_load_64(&c->_tail, ATOMIC_RELAXED) - c->_head_cache <= c->_mask;
+}
+
+static rcode channel_sleep(struct Channel *c, uint32_t side) {
+	if (!c) return DESCENT_ERROR_NULL;
+	if (!c->_doorbell) return DESCENT_ERROR_STATE;
+
+	if (channel_ready(c, side)) return 0;
+
+	rcode result = 0;
+
+	// Announce the sleep, then check once more before parking. The other side
+	// either sees the announcement and rings, or its progress is seen here.
+	for (;;) {
+		uint32_t e = atomic_load_32(&c->_bell, ATOMIC_ACQUIRE);
+		atomic_fetch_or_32(&c->_sleeping, side, ATOMIC_SEQ_CST);
+
+		if (channel_ready(c, side)) break;
+
+		result = futex_wait(&c->_bell, e);
+		if (result) break;
+	}
+
+	atomic_fetch_and_32(&c->_sleeping, ~side, ATOMIC_RELAXED);
+	return result;
+}
+
+rcode channel_wait(struct Channel *c) {
+	return channel_sleep(c, CHANNEL_SLEEPING_CONSUMER);
+}
+
+rcode channel_wait_space(struct Channel *c) {
+	return channel_sleep(c, CHANNEL_SLEEPING_PRODUCER);
+}
@@ -15,19 +15,34 @@
 
 #include <descent/thread/condition.h>
 
+#include <stdint.h>
+
 #include <descent/rcode.h>
 #include <descent/thread/atomic.h>
 #include <descent/thread/futex.h>
 #include <descent/utilities/builtin.h>
+#include <intern/thread/condition.h>
 #include <intern/thread/tid.h>
 
+// Threads in wait_any() wait on a separate futex, since a requeue would move
+// them onto the lock's futex, where a wake meant for a lock waiter could be
+// spent on them. A waiter registers before checking the generation, and a
+// signal checks for waiters after advancing it, so one always sees the other.
+static void condition_notify_any(struct Condition *c) {
+	if (!atomic_load_32(&c->_any_waiters, ATOMIC_SEQ_CST)) return;
+
+	atomic_fetch_add_32(&c->_any, 1, ATOMIC_SEQ_CST);
+	futex_wake_all(&c->_any);
+}
+
 rcode condition_signal(struct Condition *c) {
 	if (!c) return DESCENT_ERROR_NULL;
 
 	// Check that the current thread has permission to call this function
 	if (builtin_expect(tid_is_self(TID_NONE), false)) return DESCENT_ERROR_FORBIDDEN;
 	
-	atomic_add_fetch_32(&c->_generation, 1, ATOMIC_RELAXED);
+	atomic_add_fetch_32(&c->_generation, 1, ATOMIC_SEQ_CST);
+	condition_notify_any(c);
 
 	return futex_wake_next(&c->_generation);
 }
@@ -38,7 +53,19 @@ rcode condition_broadcast(struct Condition *c) {
 	// Check that the current thread has permission to call this function
 	if (builtin_expect(tid_is_self(TID_NONE), false)) return DESCENT_ERROR_FORBIDDEN;
 	
-	atomic_add_fetch_32(&c->_generation, 1, ATOMIC_RELAXED);
+	uint32_t generation = atomic_add_fetch_32(&c->_generation, 1, ATOMIC_SEQ_CST);
+	condition_notify_any(c);
+
+	uintptr_t requeue = atomic_load_ptr(&c->_requeue, ATOMIC_SEQ_CST);
+	if (!requeue || requeue == CONDITION_REQUEUE_MIXED) return futex_wake_all(&c->_generation);
+
+	atomic_32 *lock = (atomic_32 *) requeue;
+
+	// Wake one waiter, and queue the rest on the lock, whose holders wake
+	// them one by one as they release it. If another signal got in first,
+	// fall back to waking everyone.
+	rcode result = futex_requeue(&c->_generation, generation, 1, lock);
+	if (result == THREAD_INFO_BUSY) return futex_wake_all(&c->_generation);
 
-	return futex_wake_all(&c->_generation);
+	return result;
 }
@@ -0,0 +1,221 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/epoch.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/job.h>
+#include <descent/utilities/builtin.h>
+#include <descent/utilities/platform.h>
+#include <intern/thread/thread.h>
+#include <intern/thread/tid.h>
+
+// Each thread publishes the global epoch it observed on entering a region,
+// shifted left past EPOCH_ACTIVE. The global epoch only advances once every
+// thread within a region has observed it, so a thread within a region is at
+// most one epoch behind. An object retired in epoch e may still be reachable
+// by threads in epochs e - 1 and e, and is reclaimed once the global epoch
+// reaches e + 2.
+//
+// Retired objects wait in one of three limbo lists on the retiring thread,
+// indexed by their epoch modulo three. A list whose slot is needed again is at
+// least three epochs old, so always reclaimable.
+
+#define EPOCH_ACTIVE 1ull
+#define EPOCH_LIMBO  3u
+
+struct EpochThread {
+	_Alignas(DESCENT_PLATFORM_CACHE_LINE) atomic_64 local;
+	uint32_t          nesting;
+	uint32_t          pending;       // Retired objects not yet reclaimed
+	uint64_t          limbo_epoch[EPOCH_LIMBO];
+	struct EpochNode *limbo[EPOCH_LIMBO];
+};
+
+static struct EpochThread epoch_threads[THREAD_MAX] = {0};
+
+// Threads which have entered a region, and must be checked before advancing
+static thread_id_atomic_set epoch_set = {0};
+
+static atomic_64 epoch_global = ATOMIC_INIT(0);
+
+// Threads in epoch_synchronize() park on the exit count, which is bumped as
+// regions end while any of them wait
+static atomic_32 epoch_exits   = ATOMIC_INIT(0);
+static atomic_32 epoch_waiters = ATOMIC_INIT(0);
+
+static void epoch_advance_job(void *argument);
+
+static atomic_bool advance_queued = ATOMIC_INIT(false);
+static struct Job advance_job = JOB_INIT_PRIORITY(epoch_advance_job, NULL, JOB_PRIORITY_BACKGROUND);
+
+static inline struct EpochThread *epoch_thread(void) {
+	thread_id self = tid_self();
+	if (builtin_expect(!tid_is_managed(self), false)) return NULL;
+	return &epoch_threads[tid_index(self)];
+}
+
+static void epoch_reclaim_list(struct EpochThread *t, unsigned int slot) {
+	struct EpochNode *node = t->limbo[slot];
+	t->limbo[slot] = NULL;
+
+	while (node) {
+		struct EpochNode *next = node->_next;
+		node->_reclaim(node);
+		--t->pending;
+		node = next;
+	}
+}
+
+// Reclaims the calling thread's lists which the global epoch has passed
+static void epoch_reclaim(struct EpochThread *t) {
+	if (!t->pending) return;
+
+	uint64_t global = atomic_load_64(&epoch_global, ATOMIC_ACQUIRE);
+
+	for (unsigned int slot = 0; slot < EPOCH_LIMBO; ++slot) {
+		if (t->limbo[slot] && t->limbo_epoch[slot] + 2 <= global) epoch_reclaim_list(t, slot);
+	}
+}
+
+static void epoch_advance_job(void *argument) {
+	(void) argument;
+	epoch_advance();
+
+	// The job is not touched again once its function returns
+	atomic_store_bool(&advance_queued, false, ATOMIC_RELEASE);
+}
+
+// Advances the epoch, leaving it to a background job if a thread within a
+// region holds it back, or retrying inline without a job system
+static void epoch_request_advance(void) {
+	if (!epoch_advance()) return;
+	if (atomic_exchange_bool(&advance_queued, true, ATOMIC_ACQ_REL)) return;
+
+	if (job_submit(&advance_job, 1, NULL)) {
+		atomic_store_bool(&advance_queued, false, ATOMIC_RELEASE);
+		epoch_advance();
+	}
+}
+
+rcode epoch_enter(void) {
+	struct EpochThread *t = epoch_thread();
+	if (!t) return DESCENT_ERROR_FORBIDDEN;
+
+	if (t->nesting) {
+		if (t->nesting == UINT32_MAX) return DESCENT_ERROR_OVERFLOW;
+		++t->nesting;
+		return 0;
+	}
+
+	thread_id self = tid_self();
+	if (!tid_atomic_set_contains(&epoch_set, self, ATOMIC_RELAXED)) tid_atomic_set_add(&epoch_set, self, ATOMIC_SEQ_CST);
+
+	// The published epoch must be visible to advancing threads before any
+	// shared object is read
+	uint64_t global = atomic_load_64(&epoch_global, ATOMIC_RELAXED);
+	atomic_exchange_64(&t->local, (global << 1) | EPOCH_ACTIVE, ATOMIC_SEQ_CST);
+
+	t->nesting = 1;
+
+	return 0;
+}
+
+rcode epoch_exit(void) {
+	struct EpochThread *t = epoch_thread();
+	if (!t) return DESCENT_ERROR_FORBIDDEN;
+	if (!t->nesting) return DESCENT_ERROR_STATE;
+
+	if (--t->nesting) return 0;
+
+	atomic_store_64(&t->local, 0, ATOMIC_SEQ_CST);
+
+	if (atomic_load_32(&epoch_waiters, ATOMIC_SEQ_CST)) {
+		atomic_fetch_add_32(&epoch_exits, 1, ATOMIC_SEQ_CST);
+		futex_wake_all(&epoch_exits);
+	}
+
+	epoch_reclaim(t);
+
+	return 0;
+}
+
+rcode epoch_retire(struct EpochNode *node, void (*reclaim)(struct EpochNode *node)) {
+	if (!node || !reclaim) return DESCENT_ERROR_NULL;
+
+	struct EpochThread *t = epoch_thread();
+	if (!t) return DESCENT_ERROR_FORBIDDEN;
+
+	// The object must be unlinked before the epoch it is retired in is read
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	uint64_t global = atomic_load_64(&epoch_global, ATOMIC_RELAXED);
+
+	unsigned int slot = (unsigned int) (global % EPOCH_LIMBO);
+	if (t->limbo[slot] && t->limbo_epoch[slot] != global) epoch_reclaim_list(t, slot);
+
+	node->_reclaim = reclaim;
+	node->_next = t->limbo[slot];
+	t->limbo[slot] = node;
+	t->limbo_epoch[slot] = global;
+
+	if (++t->pending % DESCENT_EPOCH_RETIRE_THRESHOLD == 0) epoch_request_advance();
+
+	if (!t->nesting) epoch_reclaim(t);
+
+	return 0;
+}
+
+rcode epoch_advance(void) {
+	uint64_t global = atomic_load_64(&epoch_global, ATOMIC_SEQ_CST);
+	thread_id_set set = tid_atomic_set_load(&epoch_set, ATOMIC_SEQ_CST);
+
+	for (unsigned int index = tid_set_next(&set, 0); index < THREAD_MAX; index = tid_set_next(&set, index + 1)) {
+		uint64_t local = atomic_load_64(&epoch_threads[index].local, ATOMIC_SEQ_CST);
+		if ((local & EPOCH_ACTIVE) && (local >> 1) != global) return THREAD_INFO_BUSY;
+	}
+
+	// Losing the race means another thread advanced it, which is as good
+	atomic_compare_exchange_64(&epoch_global, &global, global + 1, ATOMIC_SEQ_CST, ATOMIC_RELAXED);
+
+	return 0;
+}
+
+rcode epoch_synchronize(void) {
+	struct EpochThread *t = epoch_thread();
+	if (!t) return DESCENT_ERROR_FORBIDDEN;
+	if (t->nesting) return THREAD_ERROR_DEADLOCK;
+
+	while (t->pending) {
+		uint32_t exits = atomic_load_32(&epoch_exits, ATOMIC_SEQ_CST);
+
+		if (epoch_advance()) {
+			// Check again once registered, so that an exit in between is not
+			// missed
+			atomic_fetch_add_32(&epoch_waiters, 1, ATOMIC_SEQ_CST);
+			if (epoch_advance()) futex_wait(&epoch_exits, exits);
+			atomic_fetch_sub_32(&epoch_waiters, 1, ATOMIC_SEQ_CST);
+		}
+
+		epoch_reclaim(t);
+	}
+
+	return 0;
+}
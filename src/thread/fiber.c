@@ -0,0 +1,99 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/utilities/platform.h>
+#if defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+#include "fiber/windows.ic"
+#else
+
+#include <descent/thread/fiber.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/alloc/sysalloc.h>
+#include <descent/rcode.h>
+
+#if defined(DESCENT_PLATFORM_ARCHITECTURE_X86_64)
+#include "fiber/x86_64.ic"
+#elif defined(DESCENT_PLATFORM_ARCHITECTURE_ARM_64)
+#include "fiber/arm_64.ic"
+#endif
+
+rcode fiber_create(struct Fiber *f, size_t stack_size, void (*function)(void *), void *argument) {
+	if (!f || !function) return DESCENT_ERROR_NULL;
+
+	*f = (struct Fiber) FIBER_INIT;
+
+#if defined(FIBER_FRAME_SIZE)
+
+	size_t granularity = sysalloc_granularity();
+	if (!granularity) return DESCENT_ERROR_OS;
+
+	if (!stack_size) stack_size = DESCENT_FIBER_STACK_SIZE;
+	stack_size = (stack_size + granularity - 1) & ~(granularity - 1);
+
+	// The lowest page is reserved but never committed, so an overflow faults
+	f->_stack.size = stack_size + granularity;
+	rcode result = sysalloc_reserve(&f->_stack);
+	if (result) return result;
+
+	result = sysalloc_commit(&f->_stack, granularity, stack_size, SYSALLOC_ACCESS_READ_WRITE);
+	if (result) {
+		sysfree(&f->_stack);
+		f->_stack = (Sysalloc) {0};
+		return result;
+	}
+
+	f->_function = function;
+	f->_argument = argument;
+
+	// Build a frame that the first switch restores into the entry trampoline
+	char *top = (char *) f->_stack.base + f->_stack.size;
+	f->_context = top - FIBER_FRAME_SIZE;
+	fiber_frame_init(f->_context, function, argument);
+
+	return 0;
+
+#else
+
+	(void) stack_size;
+	(void) argument;
+	return DESCENT_ERROR_UNSUPPORTED;
+
+#endif
+}
+
+rcode fiber_destroy(struct Fiber *f) {
+	if (!f) return DESCENT_ERROR_NULL;
+
+	rcode result = 0;
+	if (f->_stack.base) result = sysfree(&f->_stack);
+
+	*f = (struct Fiber) FIBER_INIT;
+	return result;
+}
+
+void fiber_switch(struct Fiber *from, struct Fiber *to) {
+#if defined(FIBER_FRAME_SIZE)
+	fiber_context_switch(&from->_context, to->_context);
+#else
+	(void) from;
+	(void) to;
+#endif
+}
+
+#endif
@@ -22,4 +22,4 @@
 #include "futex/windows.ic"
 #endif
 
-
+#include "futex/any.ic"
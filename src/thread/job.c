@@ -0,0 +1,976 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/job.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/fiber.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/thread.h>
+#include <descent/thread/tls.h>
+#include <descent/thread/topology.h>
+#include <descent/utilities/builtin.h>
+#include <descent/utilities/platform.h>
+#include <intern/thread/hints.h>
+#include <intern/thread/job.h>
+#include <intern/thread/tid.h>
+
+_Static_assert(!(DESCENT_JOB_QUEUE_SIZE & (DESCENT_JOB_QUEUE_SIZE - 1)), "Job queue size must be a power of two");
+
+// Steal attempts made by an idle worker before it parks
+#define JOB_SPIN_COUNT 64u
+
+#define JOB_QUEUE_MASK ((uint64_t) DESCENT_JOB_QUEUE_SIZE - 1)
+
+// Set on a counter while the thread which finished its last job releases its
+// pending jobs. Waiters treat the counter as nonzero until it is cleared.
+#define JOB_COUNTER_RELEASING 0x80000000u
+
+// Set on a counter when a thread parks waiting for it
+#define JOB_COUNTER_WAITING 0x40000000u
+
+#define JOB_COUNTER_MASK 0x3FFFFFFFu
+
+// A Chase-Lev work-stealing deque. The owning thread pushes and pops at the
+// bottom, and other threads steal from the top.
+struct JobQueue {
+	atomic_64  top;
+	char       _pad0[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+	atomic_64  bottom;
+	char       _pad1[DESCENT_PLATFORM_CACHE_LINE - sizeof(atomic_64)];
+	atomic_ptr slots[DESCENT_JOB_QUEUE_SIZE];
+};
+
+// Each priority lane has its own queues, indexed by the owning thread's TID
+// index
+static struct JobQueue queues[JOB_PRIORITY_COUNT][THREAD_MAX] = {0};
+
+// Threads whose queues in each lane have been pushed to, and which may hold
+// work
+static thread_id_atomic_set queue_set[JOB_PRIORITY_COUNT] = {0};
+
+// Threads sharing a last-level cache with each thread, which are stolen from
+// first. Only set for workers pinned by job_start_per_core().
+static thread_id_set steal_near[THREAD_MAX] = {0};
+static struct CpuMask worker_affinity[DESCENT_WORKER_THREAD_COUNT_MAX] = {0};
+
+// Background jobs running at once, which is kept below the limit so that the
+// remaining workers are always free for frame work. Background jobs waiting on
+// a counter do not count.
+static atomic_32 background_running = ATOMIC_INIT(0);
+static atomic_32 background_limit   = ATOMIC_INIT(0);
+
+// Workers park on the epoch, which is bumped whenever work is published while
+// any worker is asleep
+static atomic_32 epoch    = ATOMIC_INIT(0);
+static atomic_32 sleepers = ATOMIC_INIT(0);
+static atomic_32 running  = ATOMIC_INIT(0);
+
+// Workers at or above the active count park on it until the pool grows again,
+// so that the pool can shrink without collecting its threads
+static atomic_32 worker_active = ATOMIC_INIT(0);
+
+// Worker threads spawned, which are kept until the job system stops
+static unsigned int worker_count = 0;
+
+static TLS uint64_t steal_state = 0;
+
+#if DESCENT_JOB_FIBERS
+
+// Fibers which run the worker loop. A fiber is either running, suspended in
+// job_wait() until its counter finishes, or free. Free fibers are fresh or
+// suspended at the top of the worker loop, so resuming one always continues
+// the loop.
+struct JobFiber {
+	struct Fiber     fiber;
+	struct JobFiber *ready_next;
+	atomic_32        free_next;  // Index + 1, or 0
+	JobPriority      priority;   // Priority of the running job
+};
+
+static struct JobFiber job_fibers[DESCENT_JOB_FIBER_COUNT] = {0};
+
+// Free fibers, as a stack of indices tagged against ABA in the upper 32 bits
+static atomic_64 fibers_free = ATOMIC_INIT(0);
+
+// Suspended fibers whose counters have finished
+static atomic_ptr fibers_ready = ATOMIC_INIT(0);
+
+// Fibers suspended on counters, which workers must not exit without
+static atomic_32 fibers_waiting = ATOMIC_INIT(0);
+
+enum {
+	JOB_FIBER_ACTION_NONE = 0,
+	JOB_FIBER_ACTION_RECYCLE, // Return the previous fiber to the free stack
+	JOB_FIBER_ACTION_WAIT,    // Hold the previous fiber's resume job on a counter
+};
+
+// A fiber which switches away leaves an action to be run by the fiber it
+// switches to, once its own context is fully saved
+struct JobFiberState {
+	struct JobFiber   *current;
+	struct Fiber       thread;
+	int                action;
+	struct JobFiber   *action_fiber;
+	struct JobCounter *action_counter;
+	struct Job        *action_job;
+};
+
+static TLS struct JobFiberState fiber_state = {0};
+
+#endif
+
+// Priority of the job the thread is running outside of a fiber
+static TLS JobPriority thread_priority = JOB_PRIORITY_NORMAL;
+
+#define JOB_STEAL_EMPTY NULL
+#define JOB_STEAL_ABORT ((struct Job *) 1)
+
+static inline bool job_queue_push(struct JobQueue *q, struct Job *job) {
+	int64_t b = (int64_t) atomic_load_64(&q->bottom, ATOMIC_RELAXED);
+	int64_t t = (int64_t) atomic_load_64(&q->top, ATOMIC_ACQUIRE);
+
+	if (b - t >= (int64_t) DESCENT_JOB_QUEUE_SIZE) return false;
+
+	atomic_store_ptr(&q->slots[(uint64_t) b & JOB_QUEUE_MASK], (uintptr_t) job, ATOMIC_RELAXED);
+	atomic_thread_fence(ATOMIC_RELEASE);
+	atomic_store_64(&q->bottom, (uint64_t) (b + 1), ATOMIC_RELAXED);
+	return true;
+}
+
+static inline struct Job *job_queue_pop(struct JobQueue *q) {
+	int64_t b = (int64_t) atomic_load_64(&q->bottom, ATOMIC_RELAXED) - 1;
+	atomic_store_64(&q->bottom, (uint64_t) b, ATOMIC_RELAXED);
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	int64_t t = (int64_t) atomic_load_64(&q->top, ATOMIC_RELAXED);
+
+	// Empty
+	if (t > b) {
+		atomic_store_64(&q->bottom, (uint64_t) (b + 1), ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	struct Job *job = (struct Job *) atomic_load_ptr(&q->slots[(uint64_t) b & JOB_QUEUE_MASK], ATOMIC_RELAXED);
+
+	// The last job may be raced for by a thief
+	if (t == b) {
+		uint64_t expected = (uint64_t) t;
+		if (!atomic_compare_exchange_64(&q->top, &expected, (uint64_t) (t + 1), ATOMIC_SEQ_CST, ATOMIC_RELAXED)) job = NULL;
+		atomic_store_64(&q->bottom, (uint64_t) (b + 1), ATOMIC_RELAXED);
+	}
+
+	return job;
+}
+
+static inline struct Job *job_queue_steal(struct JobQueue *q) {
+	int64_t t = (int64_t) atomic_load_64(&q->top, ATOMIC_ACQUIRE);
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	int64_t b = (int64_t) atomic_load_64(&q->bottom, ATOMIC_ACQUIRE);
+
+	if (t >= b) return JOB_STEAL_EMPTY;
+
+	struct Job *job = (struct Job *) atomic_load_ptr(&q->slots[(uint64_t) t & JOB_QUEUE_MASK], ATOMIC_RELAXED);
+
+	uint64_t expected = (uint64_t) t;
+	if (!atomic_compare_exchange_64(&q->top, &expected, (uint64_t) (t + 1), ATOMIC_SEQ_CST, ATOMIC_RELAXED)) return JOB_STEAL_ABORT;
+
+	return job;
+}
+
+// Not inlined, so that a fiber which moves between threads never reuses the
+// address of another thread's state
+__attribute__((noinline)) static uint64_t job_random(void) {
+	// xorshift64, seeded per thread from its TID
+	uint64_t x = steal_state;
+	if (!x) x = tid_self() * 0x9E3779B97F4A7C15ull;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	steal_state = x;
+	return x;
+}
+
+// Steals from one lane of the queues of the threads in a set, from index
+// "begin" up to but excluding "end"
+static struct Job *job_steal_range(const thread_id_set *set, unsigned int lane, unsigned int begin, unsigned int end) {
+	for (unsigned int victim = tid_set_next(set, begin); victim < end; victim = tid_set_next(set, victim + 1)) {
+		struct Job *job = job_queue_steal(&queues[lane][victim]);
+
+		// A lost race means the victim still had work, so try it once more
+		if (job == JOB_STEAL_ABORT) job = job_queue_steal(&queues[lane][victim]);
+		if (job != JOB_STEAL_EMPTY && job != JOB_STEAL_ABORT) return job;
+	}
+
+	return NULL;
+}
+
+// Steals from one lane of the queues of other threads, starting at a random
+// victim and wrapping around. Threads sharing the caller's cache are tried
+// first, while the stolen job's data may still be warm.
+static struct Job *job_steal(unsigned int self, unsigned int lane) {
+	thread_id_set set = tid_atomic_set_load(&queue_set[lane], ATOMIC_ACQUIRE);
+	set = tid_set_remove(set, tid_from_index(self));
+	if (tid_set_is_empty(set)) return NULL;
+
+	unsigned int start = (unsigned int) (job_random() % THREAD_MAX);
+	struct Job *job = NULL;
+
+	thread_id_set near = tid_set_intersection(set, steal_near[self]);
+	if (!tid_set_is_empty(near)) {
+		job = job_steal_range(&near, lane, start, THREAD_MAX);
+		if (!job) job = job_steal_range(&near, lane, 0, start);
+		if (job) return job;
+	}
+
+	job = job_steal_range(&set, lane, start, THREAD_MAX);
+	return job ? job : job_steal_range(&set, lane, 0, start);
+}
+
+static inline void job_wake(unsigned int count) {
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	if (!atomic_load_32(&sleepers, ATOMIC_RELAXED)) return;
+
+	atomic_fetch_add_32(&epoch, 1, ATOMIC_RELEASE);
+	futex_wake(&epoch, count);
+}
+
+static inline bool job_background_acquire(void) {
+	uint32_t value = atomic_load_32(&background_running, ATOMIC_RELAXED);
+
+	do if (value >= atomic_load_32(&background_limit, ATOMIC_RELAXED)) return false;
+	while (!atomic_compare_exchange_32(&background_running, &value, value + 1, ATOMIC_ACQUIRE, ATOMIC_RELAXED));
+
+	return true;
+}
+
+static inline void job_background_release(bool wake) {
+	atomic_fetch_sub_32(&background_running, 1, ATOMIC_RELEASE);
+
+	// A worker may have parked because the limit was reached
+	if (wake && !tid_set_is_empty(tid_atomic_set_load(&queue_set[JOB_PRIORITY_BACKGROUND], ATOMIC_RELAXED))) job_wake(1);
+}
+
+static inline struct Job *job_take(unsigned int self, unsigned int lane, bool steal) {
+	struct Job *job = job_queue_pop(&queues[lane][self]);
+	return (job || !steal) ? job : job_steal(self, lane);
+}
+
+// Finds a job, draining higher priority lanes first. Background jobs are only
+// taken while the background limit allows, and the caller must release the
+// slot once the job is done.
+static struct Job *job_find(unsigned int self, bool background, bool steal) {
+	for (unsigned int lane = 0; lane < JOB_PRIORITY_BACKGROUND; ++lane) {
+		struct Job *job = job_take(self, lane, steal);
+		if (job) return job;
+	}
+
+	if (!background || !job_background_acquire()) return NULL;
+
+	struct Job *job = job_take(self, JOB_PRIORITY_BACKGROUND, steal);
+	if (!job) job_background_release(false);
+	return job;
+}
+
+static void job_run(struct Job *job);
+
+// Pushes a list of jobs onto the calling thread's queues
+static void job_release(struct Job *list) {
+	unsigned int self = tid_index(tid_self());
+	unsigned int lanes = 0;
+	unsigned int count = 0;
+
+	while (list) {
+		struct Job *next = list->_next;
+		list->_next = NULL;
+
+		unsigned int lane = (unsigned int) list->priority;
+		if (!(lanes & (1u << lane))) {
+			lanes |= 1u << lane;
+			tid_atomic_set_add(&queue_set[lane], tid_from_index(self), ATOMIC_RELEASE);
+		}
+
+		// Run jobs inline when the queue is full
+		if (job_queue_push(&queues[lane][self], list)) ++count;
+		else job_run(list);
+
+		list = next;
+	}
+
+	if (count) job_wake(count);
+}
+
+static void job_counter_finish(struct JobCounter *c) {
+	uint32_t value = atomic_load_32(&c->_count, ATOMIC_RELAXED);
+	uint32_t desired;
+	bool last;
+
+	do {
+		last = (value & (JOB_COUNTER_MASK | JOB_COUNTER_RELEASING)) == 1;
+		desired = last ? JOB_COUNTER_RELEASING : value - 1;
+	} while (!atomic_compare_exchange_32(&c->_count, &value, desired, ATOMIC_SEQ_CST, ATOMIC_RELAXED));
+
+	if (!last) return;
+
+	// This thread finished the last job, so it releases the pending jobs
+	job_release((struct Job *) atomic_exchange_ptr(&c->_pending, 0, ATOMIC_SEQ_CST));
+
+	// The counter may be reused or destroyed as soon as it is cleared
+	uint32_t cleared = atomic_fetch_sub_32(&c->_count, JOB_COUNTER_RELEASING, ATOMIC_SEQ_CST);
+
+	// Waiters park alongside idle workers, so wake them all to recheck
+	if ((value | cleared) & JOB_COUNTER_WAITING) {
+		atomic_fetch_add_32(&epoch, 1, ATOMIC_RELEASE);
+		futex_wake_all(&epoch);
+	}
+}
+
+static void job_run(struct Job *job) {
+	// The job may be released as soon as its counter reaches zero
+	struct JobCounter *counter = job->_counter;
+
+	job->function(job->argument);
+
+	if (counter) job_counter_finish(counter);
+}
+
+// Holds a linked list of jobs on a counter until it finishes
+static void job_hold(struct JobCounter *dependency, struct Job *jobs, unsigned int count) {
+	// Push the list onto the dependency's pending stack
+	uintptr_t head = atomic_load_ptr(&dependency->_pending, ATOMIC_RELAXED);
+	do jobs[count - 1]._next = (struct Job *) head;
+	while (!atomic_compare_exchange_ptr(&dependency->_pending, &head, (uintptr_t) jobs, ATOMIC_SEQ_CST, ATOMIC_RELAXED));
+
+	// If the dependency has already finished, nobody else will release the
+	// pending jobs. A release in progress is waited out, since it may have
+	// taken the stack before these jobs were pushed.
+	uint32_t value;
+	while ((value = atomic_load_32(&dependency->_count, ATOMIC_SEQ_CST)) & JOB_COUNTER_RELEASING) {
+		thread_spin_hint();
+	}
+
+	if (!(value & JOB_COUNTER_MASK)) job_release((struct Job *) atomic_exchange_ptr(&dependency->_pending, 0, ATOMIC_SEQ_CST));
+}
+
+#if DESCENT_JOB_FIBERS
+
+// A fiber may resume on a different thread than it was suspended on, so thread
+// locals must be looked up again after every switch. The volatile pointer keeps
+// the compiler from reusing an address computed before the switch.
+__attribute__((noinline)) static struct JobFiberState *job_fiber_state(void) {
+	struct JobFiberState *volatile state = &fiber_state;
+	return state;
+}
+
+static void job_fiber_free(struct JobFiber *f) {
+	uint32_t index = (uint32_t) (f - job_fibers) + 1;
+	uint64_t head = atomic_load_64(&fibers_free, ATOMIC_RELAXED);
+	uint64_t desired;
+
+	do {
+		atomic_store_32(&f->free_next, (uint32_t) head, ATOMIC_RELAXED);
+		desired = (((head >> 32) + 1) << 32) | index;
+	} while (!atomic_compare_exchange_64(&fibers_free, &head, desired, ATOMIC_RELEASE, ATOMIC_RELAXED));
+}
+
+static void job_fiber_main(void *argument);
+
+// Takes a free fiber, creating its stack on first use
+static struct JobFiber *job_fiber_acquire(void) {
+	uint64_t head = atomic_load_64(&fibers_free, ATOMIC_ACQUIRE);
+	struct JobFiber *f;
+
+	for (;;) {
+		uint32_t index = (uint32_t) head;
+		if (!index) return NULL;
+
+		f = &job_fibers[index - 1];
+		uint64_t desired = (((head >> 32) + 1) << 32) | atomic_load_32(&f->free_next, ATOMIC_RELAXED);
+		if (atomic_compare_exchange_64(&fibers_free, &head, desired, ATOMIC_ACQUIRE, ATOMIC_ACQUIRE)) break;
+	}
+
+	if (!f->fiber._context && fiber_create(&f->fiber, DESCENT_JOB_FIBER_STACK_SIZE, job_fiber_main, f)) {
+		job_fiber_free(f);
+		return NULL;
+	}
+
+	return f;
+}
+
+// Job which marks a suspended fiber as ready to resume
+static void job_fiber_ready(void *argument) {
+	struct JobFiber *f = argument;
+
+	uintptr_t head = atomic_load_ptr(&fibers_ready, ATOMIC_RELAXED);
+	do f->ready_next = (struct JobFiber *) head;
+	while (!atomic_compare_exchange_ptr(&fibers_ready, &head, (uintptr_t) f, ATOMIC_RELEASE, ATOMIC_RELAXED));
+
+	atomic_fetch_sub_32(&fibers_waiting, 1, ATOMIC_RELEASE);
+	job_wake(1);
+}
+
+static struct JobFiber *job_fiber_take_ready(void) {
+	if (!atomic_load_ptr(&fibers_ready, ATOMIC_RELAXED)) return NULL;
+
+	struct JobFiber *list = (struct JobFiber *) atomic_exchange_ptr(&fibers_ready, 0, ATOMIC_ACQUIRE);
+	if (!list) return NULL;
+
+	// Put back all but the first
+	struct JobFiber *rest = list->ready_next;
+	if (rest) {
+		struct JobFiber *tail = rest;
+		while (tail->ready_next) tail = tail->ready_next;
+
+		uintptr_t head = atomic_load_ptr(&fibers_ready, ATOMIC_RELAXED);
+		do tail->ready_next = (struct JobFiber *) head;
+		while (!atomic_compare_exchange_ptr(&fibers_ready, &head, (uintptr_t) rest, ATOMIC_RELEASE, ATOMIC_RELAXED));
+	}
+
+	return list;
+}
+
+// Runs the action left by the fiber which switched to this one
+static void job_fiber_after_switch(void) {
+	struct JobFiberState *state = job_fiber_state();
+	int action = state->action;
+	state->action = JOB_FIBER_ACTION_NONE;
+
+	switch (action) {
+		case JOB_FIBER_ACTION_RECYCLE:
+			job_fiber_free(state->action_fiber);
+			break;
+		case JOB_FIBER_ACTION_WAIT:
+			job_hold(state->action_counter, state->action_job, 1);
+			break;
+	}
+}
+
+// Resumes a ready fiber, if any, leaving the current one free
+static bool job_fiber_resume_ready(void) {
+	struct JobFiberState *state = job_fiber_state();
+	struct JobFiber *current = state->current;
+	if (!current) return false;
+
+	struct JobFiber *ready = job_fiber_take_ready();
+	if (!ready) return false;
+
+	state->action = JOB_FIBER_ACTION_RECYCLE;
+	state->action_fiber = current;
+	state->current = ready;
+
+	fiber_switch(&current->fiber, &ready->fiber);
+	job_fiber_after_switch();
+	return true;
+}
+
+// Suspends the current fiber until a counter finishes
+static bool job_fiber_suspend(struct JobCounter *counter) {
+	struct JobFiberState *state = job_fiber_state();
+	struct JobFiber *current = state->current;
+	if (!current) return false;
+
+	// Resuming a ready fiber directly avoids taking a free one
+	struct JobFiber *next = job_fiber_take_ready();
+	if (!next) next = job_fiber_acquire();
+	if (!next) return false;
+
+	// Lives on this fiber's stack, which is untouched until it resumes
+	struct Job resume = JOB_INIT(job_fiber_ready, current);
+
+	atomic_fetch_add_32(&fibers_waiting, 1, ATOMIC_ACQ_REL);
+
+	state->action = JOB_FIBER_ACTION_WAIT;
+	state->action_counter = counter;
+	state->action_job = &resume;
+	state->current = next;
+
+	fiber_switch(&current->fiber, &next->fiber);
+	job_fiber_after_switch();
+	return true;
+}
+
+#endif
+
+// The priority follows the job, so a suspended job keeps it on its fiber
+__attribute__((noinline)) static JobPriority *job_priority_slot(void) {
+#if DESCENT_JOB_FIBERS
+	struct JobFiberState *state = job_fiber_state();
+	if (state->current) return &state->current->priority;
+#endif
+	JobPriority *volatile slot = &thread_priority;
+	return slot;
+}
+
+// Runs a job taken by job_find()
+static void job_execute(struct Job *job) {
+	bool background = job->priority == JOB_PRIORITY_BACKGROUND;
+
+	JobPriority *slot = job_priority_slot();
+	JobPriority outer = *slot;
+	*slot = job->priority;
+
+	job_run(job);
+
+	*slot = outer;
+	if (background) job_background_release(true);
+}
+
+// Workers may only exit once no work remains
+static inline bool job_finished(void) {
+	if (atomic_load_32(&running, ATOMIC_SEQ_CST)) return false;
+#if DESCENT_JOB_FIBERS
+	if (atomic_load_32(&fibers_waiting, ATOMIC_SEQ_CST)) return false;
+	if (atomic_load_ptr(&fibers_ready, ATOMIC_SEQ_CST)) return false;
+#endif
+	return true;
+}
+
+// Parks a worker while it is above the active count. Work it was woken for is
+// passed on first, and its queues are left for other threads to steal.
+static void job_park(unsigned int self) {
+	unsigned int index = self - tid_index(tid_generate_worker(0));
+
+	uint32_t active = atomic_load_32(&worker_active, ATOMIC_ACQUIRE);
+	if (builtin_expect(index < active, true)) return;
+
+	job_wake(1);
+
+	do futex_wait(&worker_active, active);
+	while (index >= (active = atomic_load_32(&worker_active, ATOMIC_ACQUIRE)));
+}
+
+static void job_loop(void) {
+	for (;;) {
+		// After a fiber switch, the loop may continue on another thread
+		unsigned int self = tid_index(tid_self());
+
+		job_park(self);
+
+#if DESCENT_JOB_FIBERS
+		// Suspended jobs take priority over starting new ones
+		if (job_fiber_resume_ready()) continue;
+#endif
+
+		struct Job *job = job_find(self, true, true);
+
+		for (unsigned int i = 0; !job && i < JOB_SPIN_COUNT; ++i) {
+			thread_spin_hint();
+			job = job_find(self, true, true);
+		}
+
+		if (job) {
+			job_execute(job);
+			continue;
+		}
+
+		// Announce the intent to sleep, then check for work once more. A
+		// submitter either sees the sleeper and bumps the epoch, or its work
+		// is found here.
+		uint32_t e = atomic_load_32(&epoch, ATOMIC_ACQUIRE);
+		atomic_fetch_add_32(&sleepers, 1, ATOMIC_SEQ_CST);
+
+		job = job_find(self, true, true);
+#if DESCENT_JOB_FIBERS
+		bool idle = !job && !atomic_load_ptr(&fibers_ready, ATOMIC_SEQ_CST);
+#else
+		bool idle = !job;
+#endif
+		if (idle) {
+			if (job_finished()) {
+				atomic_fetch_sub_32(&sleepers, 1, ATOMIC_RELAXED);
+				break;
+			}
+
+			futex_wait(&epoch, e);
+		}
+
+		atomic_fetch_sub_32(&sleepers, 1, ATOMIC_RELAXED);
+		if (job) job_execute(job);
+	}
+}
+
+#if DESCENT_JOB_FIBERS
+
+static void job_fiber_main(void *argument) {
+	(void) argument;
+
+	for (;;) {
+		job_fiber_after_switch();
+		job_loop();
+
+		// The job system has stopped, so return to the worker's own context
+		struct JobFiberState *state = job_fiber_state();
+		struct JobFiber *current = state->current;
+
+		state->action = JOB_FIBER_ACTION_RECYCLE;
+		state->action_fiber = current;
+		state->current = NULL;
+
+		fiber_switch(&current->fiber, &state->thread);
+	}
+}
+
+#endif
+
+static int job_worker(void *argument) {
+	(void) argument;
+
+#if DESCENT_JOB_FIBERS
+	struct JobFiber *f = job_fiber_acquire();
+	if (f) {
+		struct JobFiberState *state = job_fiber_state();
+		state->current = f;
+		state->thread = (struct Fiber) FIBER_INIT;
+
+		fiber_switch(&state->thread, &f->fiber);
+		job_fiber_after_switch();
+		return 0;
+	}
+#endif
+
+	// Without a fiber, run the loop on the thread's own stack
+	job_loop();
+	return 0;
+}
+
+static void job_background_reset(unsigned int count) {
+	unsigned int limit = count * DESCENT_JOB_BACKGROUND_SHARE / 100u;
+	atomic_store_32(&background_limit, limit ? limit : 1, ATOMIC_RELAXED);
+}
+
+static void job_stop_workers(void) {
+	atomic_store_32(&running, 0, ATOMIC_SEQ_CST);
+	job_wake(UINT32_MAX);
+
+	// Parked workers are let go to drain the remaining work and exit
+	atomic_store_32(&worker_active, DESCENT_WORKER_THREAD_COUNT_MAX, ATOMIC_SEQ_CST);
+	futex_wake_all(&worker_active);
+}
+
+static rcode job_start_workers(unsigned int count, const struct CpuMask *affinity) {
+
+#if DESCENT_JOB_FIBERS
+	for (unsigned int i = 0; i < DESCENT_JOB_FIBER_COUNT; ++i) {
+		atomic_store_32(&job_fibers[i].free_next, (i + 1 < DESCENT_JOB_FIBER_COUNT) ? i + 2 : 0, ATOMIC_RELAXED);
+		job_fibers[i].priority = JOB_PRIORITY_NORMAL;
+	}
+	atomic_store_64(&fibers_free, 1, ATOMIC_RELAXED);
+	atomic_store_ptr(&fibers_ready, 0, ATOMIC_RELAXED);
+	atomic_store_32(&fibers_waiting, 0, ATOMIC_RELAXED);
+#endif
+
+	job_background_reset(count);
+	atomic_store_32(&background_running, 0, ATOMIC_RELAXED);
+
+	atomic_store_32(&worker_active, count, ATOMIC_RELAXED);
+	atomic_store_32(&running, 1, ATOMIC_SEQ_CST);
+
+	rcode result = thread_spawn_worker(count, job_worker, NULL, affinity);
+	if (result) {
+		job_stop_workers();
+		thread_collect_worker();
+		return result;
+	}
+
+	worker_count = count;
+	return 0;
+}
+
+rcode job_start(unsigned int count) {
+	// Only the main thread has permission to call this function
+	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (!count) return DESCENT_ERROR_INVALID;
+	if (worker_count) return DESCENT_ERROR_STATE;
+
+	for (unsigned int i = 0; i < THREAD_MAX; ++i) steal_near[i] = (thread_id_set) {0};
+	for (unsigned int i = 0; i < DESCENT_WORKER_THREAD_COUNT_MAX; ++i) worker_affinity[i] = (struct CpuMask) CPU_MASK_INIT;
+
+	return job_start_workers(count, NULL);
+}
+
+// Gets the cache domain of the lowest CPU in a mask
+static unsigned int job_affinity_cache(const struct Topology *t, const struct CpuMask *affinity) {
+	unsigned int first = cpu_mask_next(affinity, 0);
+
+	for (unsigned int i = 0; i < t->cpu_count; ++i) {
+		if (t->cpus[i].id == first) return t->cpus[i].domain[TOPOLOGY_DOMAIN_CACHE];
+	}
+
+	return 0;
+}
+
+rcode job_start_per_core(void) {
+	// Only the main thread has permission to call this function
+	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (worker_count) return DESCENT_ERROR_STATE;
+
+	const struct Topology *t;
+	rcode result = topology_query(&t);
+	if (result) return result;
+
+	unsigned int count;
+	// Workers added beyond one per core by job_set_worker_count() are unpinned
+	for (unsigned int i = 0; i < DESCENT_WORKER_THREAD_COUNT_MAX; ++i) worker_affinity[i] = (struct CpuMask) CPU_MASK_INIT;
+
+	result = topology_core_affinity(worker_affinity, DESCENT_WORKER_THREAD_COUNT_MAX, &count);
+	if (result) return result;
+
+	// Workers on the same cache steal from each other first
+	unsigned int cache[DESCENT_WORKER_THREAD_COUNT_MAX];
+	for (unsigned int i = 0; i < count; ++i) cache[i] = job_affinity_cache(t, &worker_affinity[i]);
+
+	for (unsigned int i = 0; i < THREAD_MAX; ++i) steal_near[i] = (thread_id_set) {0};
+
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned int self = tid_index(tid_generate_worker(i));
+
+		for (unsigned int j = 0; j < count; ++j) {
+			if (j != i && cache[j] == cache[i]) steal_near[self] = tid_set_add(steal_near[self], tid_generate_worker(j));
+		}
+	}
+
+	return job_start_workers(count, worker_affinity);
+}
+
+rcode job_stop(void) {
+	// Only the main thread has permission to call this function
+	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (!worker_count) return DESCENT_ERROR_STATE;
+
+	job_stop_workers();
+
+	rcode result = thread_collect_worker();
+	if (result) return result;
+
+	worker_count = 0;
+
+#if DESCENT_JOB_FIBERS
+	for (unsigned int i = 0; i < DESCENT_JOB_FIBER_COUNT; ++i) {
+		rcode destroyed = fiber_destroy(&job_fibers[i].fiber);
+		if (!result) result = destroyed;
+	}
+#endif
+
+	return result;
+}
+
+unsigned int job_worker_count(void) {
+	if (!worker_count) return 0;
+	return atomic_load_32(&worker_active, ATOMIC_RELAXED);
+}
+
+rcode job_set_worker_count(unsigned int count) {
+	// Only the main thread has permission to call this function
+	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (!count || count > DESCENT_WORKER_THREAD_COUNT_MAX) return DESCENT_ERROR_INVALID;
+	if (!worker_count) return DESCENT_ERROR_STATE;
+
+	uint32_t previous = atomic_load_32(&worker_active, ATOMIC_RELAXED);
+
+	// New workers must see themselves as active, or they would park at once
+	atomic_store_32(&worker_active, count, ATOMIC_SEQ_CST);
+
+	if (count > worker_count) {
+		rcode result = thread_spawn_worker(count, job_worker, NULL, worker_affinity);
+		if (result) {
+			// Workers which did spawn park until the pool grows again
+			atomic_store_32(&worker_active, previous, ATOMIC_SEQ_CST);
+			return result;
+		}
+
+		worker_count = count;
+	}
+
+	job_background_reset(count);
+
+	// Woken workers which are now above the count park again, and sleeping
+	// workers above it are moved onto the active count
+	futex_wake_all(&worker_active);
+	job_wake(UINT32_MAX);
+
+	return 0;
+}
+
+rcode job_set_background_limit(unsigned int count) {
+	if (!count) return DESCENT_ERROR_INVALID;
+	if (!atomic_load_32(&running, ATOMIC_ACQUIRE)) return DESCENT_ERROR_STATE;
+
+	atomic_store_32(&background_limit, count, ATOMIC_RELAXED);
+	job_wake(UINT32_MAX);
+	return 0;
+}
+
+unsigned int job_fiber_self(void) {
+#if DESCENT_JOB_FIBERS
+	struct JobFiber *current = job_fiber_state()->current;
+	if (current) return (unsigned int) (current - job_fibers) + 1;
+#endif
+	return 0;
+}
+
+JobPriority job_priority(void) {
+	return *job_priority_slot();
+}
+
+bool job_demand(void) {
+	if (!atomic_load_32(&running, ATOMIC_RELAXED)) return false;
+
+	unsigned int self = tid_index(tid_self());
+	if (self >= THREAD_MAX) return false;
+
+	// Queued background work is not taken while it is throttled, so it does
+	// not count against demand
+	for (unsigned int lane = 0; lane < JOB_PRIORITY_BACKGROUND; ++lane) {
+		struct JobQueue *q = &queues[lane][self];
+		int64_t t = (int64_t) atomic_load_64(&q->top, ATOMIC_RELAXED);
+		int64_t b = (int64_t) atomic_load_64(&q->bottom, ATOMIC_RELAXED);
+		if (b > t) return false;
+	}
+
+	return true;
+}
+
+static inline rcode job_prepare(struct Job *jobs, unsigned int count, struct JobCounter *counter) {
+	if (!jobs) return DESCENT_ERROR_NULL;
+
+	if (builtin_expect(!tid_is_managed(tid_self()), false)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (!atomic_load_32(&running, ATOMIC_ACQUIRE)) return DESCENT_ERROR_STATE;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (!jobs[i].function) return DESCENT_ERROR_NULL;
+		if ((unsigned int) jobs[i].priority >= JOB_PRIORITY_COUNT) return DESCENT_ERROR_INVALID;
+	}
+
+	if (counter && count) atomic_fetch_add_32(&counter->_count, count, ATOMIC_RELAXED);
+
+	// Link the jobs into a list
+	for (unsigned int i = 0; i < count; ++i) {
+		jobs[i]._counter = counter;
+		jobs[i]._next = (i + 1 < count) ? &jobs[i + 1] : NULL;
+	}
+
+	return 0;
+}
+
+rcode job_submit(struct Job *jobs, unsigned int count, struct JobCounter *counter) {
+	rcode result = job_prepare(jobs, count, counter);
+	if (result) return result;
+
+	if (count) job_release(jobs);
+	return 0;
+}
+
+rcode job_submit_after(struct JobCounter *dependency, struct Job *jobs, unsigned int count, struct JobCounter *counter) {
+	if (!dependency) return DESCENT_ERROR_NULL;
+	if (dependency == counter) return DESCENT_ERROR_INVALID;
+
+	rcode result = job_prepare(jobs, count, counter);
+	if (result || !count) return result;
+
+	job_hold(dependency, jobs, count);
+	return 0;
+}
+
+bool job_counter_park(struct JobCounter *counter, atomic_32 **futex, uint32_t *expected) {
+	// The epoch is read first, so that a finish after marking is not missed
+	uint32_t e = atomic_load_32(&epoch, ATOMIC_ACQUIRE);
+	uint32_t value = atomic_load_32(&counter->_count, ATOMIC_ACQUIRE);
+
+	do if (!(value & ~JOB_COUNTER_WAITING)) return false;
+	while (!(value & JOB_COUNTER_WAITING) && !atomic_compare_exchange_32(&counter->_count, &value, value | JOB_COUNTER_WAITING, ATOMIC_SEQ_CST, ATOMIC_ACQUIRE));
+
+	*futex = &epoch;
+	*expected = e;
+	return true;
+}
+
+rcode job_wait(struct JobCounter *counter) {
+	if (!counter) return DESCENT_ERROR_NULL;
+
+	unsigned int self = tid_index(tid_self());
+	if (builtin_expect(self >= THREAD_MAX, false)) return DESCENT_ERROR_FORBIDDEN;
+
+	// Only workers help with background jobs, so that other threads are never
+	// held up by long-running work
+	bool helper = tid_is_worker(tid_self());
+
+	// A waiting background job gives up its slot until it resumes
+	bool background = *job_priority_slot() == JOB_PRIORITY_BACKGROUND;
+	if (background) job_background_release(true);
+
+	unsigned int spins = 0;
+
+	for (;;) {
+		uint32_t value = atomic_load_32(&counter->_count, ATOMIC_ACQUIRE);
+		if (!(value & ~JOB_COUNTER_WAITING)) break;
+
+#if DESCENT_JOB_FIBERS
+		// Jobs on this thread's own queues are most likely the ones being
+		// waited on, so run them before suspending
+		self = tid_index(tid_self());
+		struct Job *own = job_find(self, helper, false);
+		if (own) {
+			job_execute(own);
+			continue;
+		}
+
+		if (job_fiber_suspend(counter)) continue;
+#endif
+
+		// Help with queued work rather than blocking
+		struct Job *job = job_find(self, helper, true);
+		if (job) {
+			job_execute(job);
+			spins = 0;
+			continue;
+		}
+
+		if (spins < JOB_SPIN_COUNT) {
+			++spins;
+			thread_spin_hint();
+			continue;
+		}
+
+		// The remaining jobs are running on other threads, or have not been
+		// released yet. Park with the idle workers, so that either new work or
+		// the counter finishing wakes this thread.
+		uint32_t e = atomic_load_32(&epoch, ATOMIC_ACQUIRE);
+		atomic_fetch_add_32(&sleepers, 1, ATOMIC_SEQ_CST);
+
+		bool park;
+		do park = (value & ~JOB_COUNTER_WAITING) != 0;
+		while (park && !atomic_compare_exchange_32(&counter->_count, &value, value | JOB_COUNTER_WAITING, ATOMIC_SEQ_CST, ATOMIC_ACQUIRE));
+
+		if (park) job = job_find(self, helper, true);
+		if (park && !job) futex_wait(&epoch, e);
+
+		atomic_fetch_sub_32(&sleepers, 1, ATOMIC_RELAXED);
+		if (job) job_execute(job);
+		spins = 0;
+	}
+
+	// Resuming may briefly exceed the limit, rather than blocking again
+	if (background) atomic_fetch_add_32(&background_running, 1, ATOMIC_ACQUIRE);
+	return 0;
+}
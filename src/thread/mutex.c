@@ -24,18 +24,79 @@
 #include <descent/thread/futex.h>
 #include <descent/time.h>
 #include <descent/utilities/builtin.h>
+#include <intern/thread/condition.h>
+#include <intern/thread/hints.h>
+#include <intern/thread/spin.h>
 #include <intern/thread/tid.h>
 
-// TODO: Implement eventual fairness
-// If a thread has consecutively held a lock for more than 1 ms, the next transition
-// must be fair
+// Eventual fairness: unlocking normally lets the releasing thread or a
+// newcomer barge ahead of parked waiters, which keeps throughput high. Once a
+// lock has stayed contended for DESCENT_MUTEX_FAIR_INTERVAL without a fair
+// transition, the next unlock hands it directly to a parked waiter instead.
 
 enum {
 	MUTEX_UNLOCKED = 0,
 	MUTEX_LOCKED,
 	MUTEX_CONTENDED,
+	MUTEX_HANDOFF,   // Unlocked, but reserved for a thread which has waited
 };
 
+// Spins while the holder is likely to release the lock soon
+static bool mutex_spin(struct Mutex *m) {
+	uint32_t limit = spin_limit(&m->_spin);
+
+	for (uint32_t spins = 0; spins < limit; ++spins) {
+		thread_spin_hint();
+
+		// Only attempt the exchange once the lock looks free, to keep the
+		// cache line shared while it is held
+		uint32_t expected = atomic_load_32(&m->_state, ATOMIC_RELAXED);
+		if (expected != MUTEX_UNLOCKED) continue;
+
+		if (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_LOCKED, ATOMIC_ACQ_REL, ATOMIC_RELAXED)) {
+			spin_learn(&m->_spin, spins, true);
+			return true;
+		}
+	}
+
+	spin_learn(&m->_spin, limit, false);
+	return false;
+}
+
+// Attempts to take a contended lock, marking it contended so that its holder
+// wakes a waiter. Only a thread which has already waited may take a lock being
+// handed off. On failure, receives the state value to wait on.
+static bool mutex_acquire_contended(struct Mutex *m, bool waited, uint32_t *value) {
+	for (;;) {
+		uint32_t state = atomic_load_32(&m->_state, ATOMIC_RELAXED);
+
+		if (state == MUTEX_UNLOCKED || (state == MUTEX_HANDOFF && waited)) {
+			if (atomic_compare_exchange_32(&m->_state, &state, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_RELAXED)) return true;
+			continue;
+		}
+
+		if (state == MUTEX_LOCKED) {
+			if (!atomic_compare_exchange_32(&m->_state, &state, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_RELAXED)) continue;
+			state = MUTEX_CONTENDED;
+		}
+
+		*value = state;
+		return false;
+	}
+}
+
+// Passes on a handoff which may have been aimed at a waiter leaving with an
+// error, since nobody else would take it
+static void mutex_pass_handoff(struct Mutex *m) {
+	uint32_t value;
+
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	if (!mutex_acquire_contended(m, true, &value)) return;
+
+	atomic_store_32(&m->_state, MUTEX_UNLOCKED, ATOMIC_RELEASE);
+	futex_wake_next(&m->_state);
+}
+
 rcode mutex_lock(struct Mutex *m) {
 	if (!m) return DESCENT_ERROR_NULL;
 
@@ -52,17 +113,25 @@ rcode mutex_lock(struct Mutex *m) {
 	// Detect re-entrant deadlocks
 	if (tid_is_self(atomic_load_64(&m->_owner, ATOMIC_ACQUIRE))) return THREAD_ERROR_DEADLOCK;
 
-	do {
-		expected = MUTEX_LOCKED;
-		bool exchange = atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE);
+	if (mutex_spin(m)) {
+		atomic_store_64(&m->_owner, tid_self(), ATOMIC_RELEASE);
+		return 0;
+	}
 
-		if (exchange || expected == MUTEX_CONTENDED) {
-			rcode result = futex_wait(&m->_state, MUTEX_CONTENDED);
-			if (result) return result;
-		}
+	bool waited = false;
+	uint32_t value;
 
-		expected = MUTEX_UNLOCKED;
-	} while (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE));
+	while (!mutex_acquire_contended(m, waited, &value)) {
+		atomic_fetch_add_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+		rcode result = futex_wait(&m->_state, value);
+		atomic_fetch_sub_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+
+		if (result) {
+			mutex_pass_handoff(m);
+			return result;
+		}
+		waited = true;
+	}
 
 	atomic_store_64(&m->_owner, tid_self(), ATOMIC_RELEASE);
 
@@ -85,26 +154,39 @@ rcode mutex_timedlock(struct Mutex *m, uint64_t nanoseconds) {
 	// Detect re-entrant deadlocks
 	if (tid_is_self(atomic_load_64(&m->_owner, ATOMIC_ACQUIRE))) return THREAD_ERROR_DEADLOCK;
 
+	if (mutex_spin(m)) {
+		atomic_store_64(&m->_owner, tid_self(), ATOMIC_RELEASE);
+		return 0;
+	}
+
 	uint64_t start = time_nanoseconds();
 	uint64_t remaining = nanoseconds;
-
-	do {
-		expected = MUTEX_LOCKED;
-		bool exchange = atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE);
-
-		if (exchange || expected == MUTEX_CONTENDED) {
-			// Wait with remaining timeout
-			rcode result = futex_timedwait(&m->_state, MUTEX_CONTENDED, remaining);
-			if (result) return result;
-
-			// Adjust remaining timeout
-			uint64_t now = time_nanoseconds();
-			if (now - start >= remaining) return THREAD_INFO_TIMEOUT;
-			remaining = nanoseconds - (now - start);
+	bool waited = false;
+	uint32_t value;
+
+	while (!mutex_acquire_contended(m, waited, &value)) {
+		// Wait with remaining timeout
+		atomic_fetch_add_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+		rcode result = futex_timedwait(&m->_state, value, remaining);
+		atomic_fetch_sub_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+		waited = true;
+
+		// Adjust remaining timeout
+		uint64_t now = time_nanoseconds();
+		if (result == THREAD_INFO_TIMEOUT || (!result && now - start >= nanoseconds)) {
+			// A handoff may have been aimed at this thread as it timed out, and
+			// nobody else would take it
+			atomic_thread_fence(ATOMIC_SEQ_CST);
+			if (mutex_acquire_contended(m, waited, &value)) break;
+			return THREAD_INFO_TIMEOUT;
 		}
 
-		expected = MUTEX_UNLOCKED;
-	} while (!atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE));
+		if (result) {
+			mutex_pass_handoff(m);
+			return result;
+		}
+		remaining = nanoseconds - (now - start);
+	}
 
 	atomic_store_64(&m->_owner, tid_self(), ATOMIC_RELEASE);
 
@@ -138,12 +220,59 @@ rcode mutex_unlock(struct Mutex *m) {
 		return DESCENT_ERROR_FORBIDDEN;
 	}
 
+	// Only the owner writes the fairness timestamp, and waiters only move the
+	// state from locked to contended, so it cannot change under this check
+	if (atomic_load_32(&m->_state, ATOMIC_RELAXED) == MUTEX_CONTENDED) {
+		uint64_t now = time_nanoseconds();
+
+		if (!m->_contended_since) m->_contended_since = now;
+		else if (now - m->_contended_since >= DESCENT_MUTEX_FAIR_INTERVAL) {
+			m->_contended_since = 0;
+
+			// Publish the handoff before checking for waiters. A waiter which
+			// leaves either sees the handoff and takes it, or is not counted.
+			atomic_store_32(&m->_state, MUTEX_HANDOFF, ATOMIC_SEQ_CST);
+			if (atomic_load_32(&m->_waiters, ATOMIC_SEQ_CST)) return futex_wake_next(&m->_state);
+
+			// Nobody is counted, so release normally unless a leaving waiter
+			// already took the lock. Condition waiters requeued onto the lock
+			// are not counted, so one is still woken.
+			uint32_t expected = MUTEX_HANDOFF;
+			if (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_UNLOCKED, ATOMIC_RELEASE, ATOMIC_RELAXED)) return futex_wake_next(&m->_state);
+			return 0;
+		}
+	} else {
+		m->_contended_since = 0;
+	}
+
 	uint32_t old_state = atomic_exchange_32(&m->_state, MUTEX_UNLOCKED, ATOMIC_RELEASE);
 	if (old_state == MUTEX_CONTENDED) result = futex_wake_next(&m->_state);
 
 	return result;
 }
 
+// Re-acquires the mutex after waiting on a condition. The thread may have
+// been requeued onto the lock by a broadcast, and must mark the lock as
+// contended so that its release wakes the next requeued thread.
+static rcode mutex_relock(struct Mutex *m) {
+	uint32_t value;
+
+	while (!mutex_acquire_contended(m, true, &value)) {
+		atomic_fetch_add_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+		rcode result = futex_wait(&m->_state, value);
+		atomic_fetch_sub_32(&m->_waiters, 1, ATOMIC_SEQ_CST);
+
+		if (result) {
+			mutex_pass_handoff(m);
+			return result;
+		}
+	}
+
+	atomic_store_64(&m->_owner, tid_self(), ATOMIC_RELEASE);
+
+	return 0;
+}
+
 rcode mutex_wait(struct Mutex *m, struct Condition *c) {
 	if (!m || !c) return DESCENT_ERROR_NULL;
 
@@ -153,13 +282,38 @@ rcode mutex_wait(struct Mutex *m, struct Condition *c) {
 	if (builtin_expect(tid_is_self(TID_NONE), false)) return DESCENT_ERROR_FORBIDDEN;
 	
 	uint32_t expected = atomic_load_32(&c->_generation, ATOMIC_RELAXED);
+	condition_record_lock(c, &m->_state);
 	
 	result = mutex_unlock(m);
 	if (result) return result;
 
 	rcode futex_result = futex_wait(&c->_generation, expected);
 
-	result = mutex_lock(m);
+	result = mutex_relock(m);
+	if (result) return result;
+
+	return futex_result;
+}
+
+rcode mutex_timedwait(struct Mutex *m, struct Condition *c, uint64_t nanoseconds) {
+	if (!m || !c) return DESCENT_ERROR_NULL;
+
+	rcode result = 0;
+
+	// Check that the current thread has permission to call this function
+	if (builtin_expect(tid_is_self(TID_NONE), false)) return DESCENT_ERROR_FORBIDDEN;
+	
+	uint32_t expected = atomic_load_32(&c->_generation, ATOMIC_RELAXED);
+	condition_record_lock(c, &m->_state);
+	
+	result = mutex_unlock(m);
+	if (result) return result;
+
+	// A requeued thread may time out on the lock instead, which is reported
+	// the same way
+	rcode futex_result = futex_timedwait(&c->_generation, expected, nanoseconds);
+
+	result = mutex_relock(m);
 	if (result) return result;
 
 	return futex_result;
@@ -0,0 +1,184 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/parallel.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/job.h>
+#include <descent/utilities/builtin.h>
+#include <intern/thread/job.h>
+#include <intern/thread/tid.h>
+
+// Each split halves the remaining range, so a range can be split at most once
+// per bit of its size
+#define PARALLEL_SPLIT_MAX (sizeof(size_t) * 8)
+
+// Grains per thread picked for parallel_for() when no grain is given
+#define PARALLEL_GRAINS_PER_THREAD 8u
+
+struct ParallelFor {
+	void (*function)(size_t begin, size_t end, void *context);
+	void *context;
+	size_t grain;
+	JobPriority priority; // Priority of the calling job, inherited by splits
+};
+
+struct ParallelForRange {
+	const struct ParallelFor *loop;
+	size_t begin;
+	size_t end;
+};
+
+struct ParallelReduce {
+	void (*map)(size_t begin, size_t end, void *value, void *context);
+	void (*combine)(void *value, const void *other, void *context);
+	const void *identity;
+	void *context;
+	size_t size;
+	size_t grain;
+	JobPriority priority; // Priority of the calling job, inherited by splits
+};
+
+struct ParallelReduceRange {
+	const struct ParallelReduce *reduce;
+	size_t begin;
+	size_t end;
+	void *value;
+};
+
+static void parallel_for_job(void *argument);
+
+static void parallel_for_range(const struct ParallelFor *loop, size_t begin, size_t end) {
+	struct ParallelForRange ranges[PARALLEL_SPLIT_MAX];
+	struct Job jobs[PARALLEL_SPLIT_MAX];
+	struct JobCounter counter = JOB_COUNTER_INIT;
+	unsigned int split = 0;
+
+	while (begin < end) {
+		size_t remaining = end - begin;
+
+		// Offer the upper half once everything offered so far has been taken
+		if (remaining > loop->grain && split < PARALLEL_SPLIT_MAX && job_demand()) {
+			size_t middle = begin + remaining / 2;
+
+			ranges[split] = (struct ParallelForRange) {.loop = loop, .begin = middle, .end = end};
+			jobs[split] = (struct Job) JOB_INIT_PRIORITY(parallel_for_job, &ranges[split], loop->priority);
+
+			if (!job_submit(&jobs[split], 1, &counter)) {
+				end = middle;
+				++split;
+				continue;
+			}
+		}
+
+		size_t chunk = remaining < loop->grain ? remaining : loop->grain;
+		loop->function(begin, begin + chunk, loop->context);
+		begin += chunk;
+	}
+
+	// The split ranges live on this stack
+	if (split) job_wait(&counter);
+}
+
+static void parallel_for_job(void *argument) {
+	struct ParallelForRange *range = argument;
+	parallel_for_range(range->loop, range->begin, range->end);
+}
+
+rcode parallel_for(size_t begin, size_t end, size_t grain, void (*function)(size_t begin, size_t end, void *context), void *context) {
+	if (!function) return DESCENT_ERROR_NULL;
+
+	if (builtin_expect(!tid_is_managed(tid_self()), false)) return DESCENT_ERROR_FORBIDDEN;
+
+	if (begin >= end) return 0;
+
+	unsigned int workers = job_worker_count();
+	if (!workers) {
+		function(begin, end, context);
+		return 0;
+	}
+
+	if (!grain) {
+		grain = (end - begin) / (((size_t) workers + 1) * PARALLEL_GRAINS_PER_THREAD);
+		if (!grain) grain = 1;
+	}
+
+	struct ParallelFor loop = {.function = function, .context = context, .grain = grain, .priority = job_priority()};
+	parallel_for_range(&loop, begin, end);
+	return 0;
+}
+
+static void parallel_reduce_job(void *argument);
+
+static void parallel_reduce_range(const struct ParallelReduce *reduce, size_t begin, size_t end, void *value) {
+	memcpy(value, reduce->identity, reduce->size);
+
+	if (end - begin <= reduce->grain) {
+		if (begin < end) reduce->map(begin, end, value, reduce->context);
+		return;
+	}
+
+	// The split point depends only on the range, so the tree is the same
+	// whichever thread runs each half
+	size_t middle = begin + (end - begin) / 2;
+
+	_Alignas(max_align_t) unsigned char other[DESCENT_PARALLEL_VALUE_SIZE_MAX];
+	struct ParallelReduceRange right = {.reduce = reduce, .begin = middle, .end = end, .value = other};
+	struct Job job = JOB_INIT_PRIORITY(parallel_reduce_job, &right, reduce->priority);
+	struct JobCounter counter = JOB_COUNTER_INIT;
+
+	bool split = job_demand() && !job_submit(&job, 1, &counter);
+
+	parallel_reduce_range(reduce, begin, middle, value);
+
+	if (split) job_wait(&counter);
+	else parallel_reduce_range(reduce, middle, end, other);
+
+	reduce->combine(value, other, reduce->context);
+}
+
+static void parallel_reduce_job(void *argument) {
+	struct ParallelReduceRange *range = argument;
+	parallel_reduce_range(range->reduce, range->begin, range->end, range->value);
+}
+
+rcode parallel_reduce(size_t begin, size_t end, size_t grain, size_t size, const void *identity, void (*map)(size_t begin, size_t end, void *value, void *context), void (*combine)(void *value, const void *other, void *context), void *result, void *context) {
+	if (!identity || !map || !combine || !result) return DESCENT_ERROR_NULL;
+
+	if (!grain || !size || size > DESCENT_PARALLEL_VALUE_SIZE_MAX) return DESCENT_ERROR_INVALID;
+
+	if (builtin_expect(!tid_is_managed(tid_self()), false)) return DESCENT_ERROR_FORBIDDEN;
+
+	struct ParallelReduce reduce = {
+		.map      = map,
+		.combine  = combine,
+		.identity = identity,
+		.context  = context,
+		.size     = size,
+		.grain    = grain,
+		.priority = job_priority(),
+	};
+
+	// The root is reduced into a local, since the result may alias the identity
+	_Alignas(max_align_t) unsigned char value[DESCENT_PARALLEL_VALUE_SIZE_MAX];
+	parallel_reduce_range(&reduce, begin, begin < end ? end : begin, value);
+	memcpy(result, value, size);
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/queue.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+
+rcode queue_init(struct Queue *q, struct QueueCell *cells, size_t capacity) {
+	if (!q || !cells) return DESCENT_ERROR_NULL;
+	if (capacity < 2 || (capacity & (capacity - 1))) return DESCENT_ERROR_INVALID;
+
+	// A cell whose sequence equals a push position is free for that push
+	for (size_t i = 0; i < capacity; ++i) {
+		atomic_store_64(&cells[i]._sequence, i, ATOMIC_RELAXED);
+		cells[i]._value = NULL;
+	}
+
+	atomic_store_64(&q->_push, 0, ATOMIC_RELAXED);
+	atomic_store_64(&q->_pop, 0, ATOMIC_RELAXED);
+	atomic_store_32(&q->_pushed, 0, ATOMIC_RELAXED);
+	atomic_store_32(&q->_popped, 0, ATOMIC_RELAXED);
+	atomic_store_32(&q->_pop_waiters, 0, ATOMIC_RELAXED);
+	atomic_store_32(&q->_push_waiters, 0, ATOMIC_RELAXED);
+	q->_cells = cells;
+	q->_mask = (uint64_t) capacity - 1;
+
+	atomic_thread_fence(ATOMIC_RELEASE);
+	return 0;
+}
+
+// Wakes a thread parked on the other end of the queue, if any
+static inline void queue_signal(atomic_32 *futex, atomic_32 *waiters) {
+	atomic_thread_fence(ATOMIC_SEQ_CST);
+	if (!atomic_load_32(waiters, ATOMIC_RELAXED)) return;
+
+	atomic_fetch_add_32(futex, 1, ATOMIC_RELEASE);
+	futex_wake_next(futex);
+}
+
+static inline bool queue_push_cell(struct Queue *q, void *value) {
+	uint64_t position = atomic_load_64(&q->_push, ATOMIC_RELAXED);
+	struct QueueCell *cell;
+
+	for (;;) {
+		cell = &q->_cells[position & q->_mask];
+		uint64_t sequence = atomic_load_64(&cell->_sequence, ATOMIC_ACQUIRE);
+		int64_t difference = (int64_t) (sequence - position);
+
+		if (!difference) {
+			if (atomic_compare_exchange_64(&q->_push, &position, position + 1, ATOMIC_RELAXED, ATOMIC_RELAXED)) break;
+		}
+
+		// The cell still holds the value from the previous lap
+		else if (difference < 0) return false;
+
+		else position = atomic_load_64(&q->_push, ATOMIC_RELAXED);
+	}
+
+	cell->_value = value;
+	atomic_store_64(&cell->_sequence, position + 1, ATOMIC_RELEASE);
+	return true;
+}
+
+static inline bool queue_pop_cell(struct Queue *q, void **value) {
+	uint64_t position = atomic_load_64(&q->_pop, ATOMIC_RELAXED);
+	struct QueueCell *cell;
+
+	for (;;) {
+		cell = &q->_cells[position & q->_mask];
+		uint64_t sequence = atomic_load_64(&cell->_sequence, ATOMIC_ACQUIRE);
+		int64_t difference = (int64_t) (sequence - (position + 1));
+
+		if (!difference) {
+			if (atomic_compare_exchange_64(&q->_pop, &position, position + 1, ATOMIC_RELAXED, ATOMIC_RELAXED)) break;
+		}
+
+		// The cell has not been filled for this lap
+		else if (difference < 0) return false;
+
+		else position = atomic_load_64(&q->_pop, ATOMIC_RELAXED);
+	}
+
+	*value = cell->_value;
+
+	// Free the cell for the push one lap ahead
+	atomic_store_64(&cell->_sequence, position + q->_mask + 1, ATOMIC_RELEASE);
+	return true;
+}
+
+rcode queue_trypush(struct Queue *q, void *value) {
+	if (!q) return DESCENT_ERROR_NULL;
+
+	if (!queue_push_cell(q, value)) return THREAD_INFO_BUSY;
+
+	queue_signal(&q->_pushed, &q->_pop_waiters);
+	return 0;
+}
+
+rcode queue_push(struct Queue *q, void *value) {
+	if (!q) return DESCENT_ERROR_NULL;
+
+	while (!queue_push_cell(q, value)) {
+		// Announce the wait before checking once more, so that a consumer
+		// either sees the waiter or its pop is seen here
+		uint32_t e = atomic_load_32(&q->_popped, ATOMIC_ACQUIRE);
+		atomic_fetch_add_32(&q->_push_waiters, 1, ATOMIC_SEQ_CST);
+
+		rcode result = 0;
+		bool pushed = queue_push_cell(q, value);
+		if (!pushed) result = futex_wait(&q->_popped, e);
+
+		atomic_fetch_sub_32(&q->_push_waiters, 1, ATOMIC_RELAXED);
+
+		if (result) return result;
+		if (pushed) break;
+	}
+
+	queue_signal(&q->_pushed, &q->_pop_waiters);
+	return 0;
+}
+
+rcode queue_trypop(struct Queue *q, void **value) {
+	if (!q || !value) return DESCENT_ERROR_NULL;
+
+	if (!queue_pop_cell(q, value)) return THREAD_INFO_BUSY;
+
+	queue_signal(&q->_popped, &q->_push_waiters);
+	return 0;
+}
+
+rcode queue_pop(struct Queue *q, void **value) {
+	if (!q || !value) return DESCENT_ERROR_NULL;
+
+	while (!queue_pop_cell(q, value)) {
+		uint32_t e = atomic_load_32(&q->_pushed, ATOMIC_ACQUIRE);
+		atomic_fetch_add_32(&q->_pop_waiters, 1, ATOMIC_SEQ_CST);
+
+		rcode result = 0;
+		bool popped = queue_pop_cell(q, value);
+		if (!popped) result = futex_wait(&q->_pushed, e);
+
+		atomic_fetch_sub_32(&q->_pop_waiters, 1, ATOMIC_RELAXED);
+
+		if (result) return result;
+		if (popped) break;
+	}
+
+	queue_signal(&q->_popped, &q->_push_waiters);
+	return 0;
+}
+
+size_t queue_count(struct Queue *q) {
+	if (!q) return 0;
+
+	uint64_t pop = atomic_load_64(&q->_pop, ATOMIC_ACQUIRE);
+	uint64_t push = atomic_load_64(&q->_push, ATOMIC_ACQUIRE);
+
+	// The positions are read separately, so the push may appear to lag
+	return push > pop ? (size_t) (push - pop) : 0;
+}
@@ -13,220 +13,276 @@
  * limitations under the License.
  */
 
-#include <descent/thread/mutex.h>
+#include <descent/thread/rwlock.h>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 #include <descent/rcode.h>
 #include <descent/thread/atomic.h>
-#include <descent/thread/condition.h>
 #include <descent/thread/futex.h>
-#include <descent/thread/tls.h>
+#include <descent/utilities/builtin.h>
 #include <intern/thread/tid.h>
 
+// Readers never touch _state. Each reader adds itself to a reader set, then
+// checks _state for writers; a writer sets WRITE_PEND_BIT, then checks the
+// reader sets. Both sides use sequentially consistent operations, so at least
+// one of them sees the other, and a reader which sees a writer backs out.
+//
+// WRITE_STATE_BIT is only ever set alongside WRITE_PEND_BIT, so readers test
+// the pending bit alone. Writers waiting for the lock keep WRITE_PEND_BIT set
+// across a release, so that readers cannot slip in between two writers.
+//
+// Readers wait on _state for the writer bits to change. Writers wait on _state
+// while another writer holds the lock, and on _drain while readers leave.
+
 #define WRITE_STATE_BIT (1u << 31)
 #define WRITE_PEND_BIT  (1u << 30)
-#define MAXIMUM_READERS (THREAD_MAX > 0xFF ? 0xFF : THREAD_MAX)
-
-_Static_assert(WRITE_STATE_BIT > MAXIMUM_READERS, "WRITE_STATE_BIT must be greater than MAXIMUM_READERS");
-_Static_assert(WRITE_PEND_BIT > MAXIMUM_READERS, "WRITE_PEND_BIT must be greater than MAXIMUM_READERS");
 
-enum {
-	RWLOCK_UNUSED = 0,
-	RWLOCK_READING,
-	RWLOCK_WRITING,
-};
+_Static_assert(DESCENT_RWLOCK_READER_WORDS * 64 >= THREAD_MAX, "Reader set must have a bit for every managed thread");
 
-struct RWLock {
-	atomic_32 _state;   // Bits: [WRITE_STATE_BIT | WRITE_PEND_BIT | reader_count (30 bits)]
-	atomic_64 _owner;   // Bitmask of owners (threads holding this lock)
+// A thread's bit in a reader set
+struct RWLockSlot {
+	atomic_64 *word;
+	uint64_t   bit;
 };
 
-// The highest bit of _state marks whether the lock is in read or write mode
-// The second-highest bit of _state marks whether the lock is in read or write mode
-// The lower 30 bits of _state count lock holders
-
-// Considerations:
-// There can be multiple locks
-// A thread can hold one (or more) locks and try to obtain another
-// Locks must be well-behaved:
-// - Forbid waiting on a held lock
-// - Forbid unlocking a lock not held
+// Threads are dealt round-robin across the words of the reader set, so that
+// with sharding, threads with neighbouring indices use different cache lines
+static inline struct RWLockSlot rwlock_reader_slot(RWLock *r, thread_id self) {
+	unsigned int index = tid_index(self);
+	if (index >= THREAD_MAX) return (struct RWLockSlot) {&r->_readers[0], 0};
+
+	if (!r->_shards) {
+		return (struct RWLockSlot) {
+			&r->_readers[index % DESCENT_RWLOCK_READER_WORDS],
+			1ull << (index / DESCENT_RWLOCK_READER_WORDS)
+		};
+	}
 
-// Atomically switch lock from write to read
-// Prefers writers initially, uses eventual fairness once the lock has been held by a
-// single writer for more than 1 ms
+	return (struct RWLockSlot) {
+		&r->_shards[index % r->_shard_count]._readers,
+		1ull << (index / r->_shard_count)
+	};
+}
 
-static inline rcode _rwlock_read_lock_base(struct RWLock *r, bool try) {
-	if (!r) return DESCENT_ERROR_NULL;
+static bool rwlock_has_readers(RWLock *r) {
+	atomic_64 *words = r->_readers;
+	size_t stride = sizeof(atomic_64);
+	unsigned int count = DESCENT_RWLOCK_READER_WORDS;
 
-	for (;;) {
-		uint32_t state = atomic_load_32(&r->_state, ATOMIC_ACQUIRE);
-
-		// This triggers if:
-		// - WRITE_STATE_BIT is set
-		// - WRITE_PEND_BIT is set
-		// - MAXIMUM_READERS is exceeded
-		bool busy = state > MAXIMUM_READERS;
-
-		if (busy) {
-			if (try) {
-				return THREAD_INFO_BUSY;
-			} else {
-				futex_wait(&r->_state, state);
-			}
-		}
+	if (r->_shards) {
+		words = &r->_shards[0]._readers;
+		stride = sizeof(struct RWLockShard);
+		count = r->_shard_count;
+	}
 
-		else if (atomic_compare_exchange_32(&r->_state, &state, state + 1, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE)) {
-			break;
-		}
+	for (unsigned int i = 0; i < count; ++i) {
+		atomic_64 *word = (atomic_64 *) ((char *) words + i * stride);
+		if (atomic_load_64(word, ATOMIC_SEQ_CST)) return true;
 	}
 
-	return 0;
+	return false;
 }
 
-static inline rcode _rwlock_write_lock_base(struct RWLock *r, bool try) {
-	if (!r) return DESCENT_ERROR_NULL;
-	if (thread_state != RWLOCK_UNUSED) return THREAD_ERROR_DEADLOCK;
-
-	// Place a pend on the lock
-	atomic_or_fetch_32(&r->_state, WRITE_PEND_BIT, ATOMIC_RELEASE);
+// Tells writers waiting for readers to leave that the reader sets changed
+static inline void rwlock_drained(RWLock *r) {
+	atomic_fetch_add_32(&r->_drain, 1, ATOMIC_SEQ_CST);
+	futex_wake_all(&r->_drain);
+}
 
-	for (;;) {
-		uint32_t state = WRITE_PEND_BIT;
+// Clears the writer bits, keeping WRITE_PEND_BIT if other writers are waiting
+static void rwlock_release_writer(RWLock *r) {
+	bool pending = atomic_load_32(&r->_pending, ATOMIC_SEQ_CST) != 0;
 
-		if (atomic_compare_exchange_32(&r->_state, &state, WRITE_STATE_BIT, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE)) {
-			break;
-		}
+	atomic_store_32(&r->_state, pending ? WRITE_PEND_BIT : 0, ATOMIC_SEQ_CST);
+	futex_wake_all(&r->_state);
 
-		rcode result = futex_wait(&r->_state, state);
-		if (result) return result;
-	}
+	// A writer may have started waiting for readers before this one got in
+	if (pending) rwlock_drained(r);
+}
 
-	thread_state = RWLOCK_WRITING;
+static rcode rwlock_check(RWLock *r, thread_id self, struct RWLockSlot slot) {
+	if (builtin_expect(!tid_is_managed(self), false)) return DESCENT_ERROR_FORBIDDEN;
+	if (atomic_load_64(&r->_writer, ATOMIC_RELAXED) == self) return THREAD_ERROR_DEADLOCK;
+	if (atomic_load_64(slot.word, ATOMIC_RELAXED) & slot.bit) return THREAD_ERROR_DEADLOCK;
 	return 0;
 }
 
-rcode rwlock_read_lock(struct RWLock *r) {
-	return _rwlock_read_lock_base(r, false);
+// Joins the reader set, backing out if a writer holds the lock or is waiting.
+// On failure, receives the state value to wait on.
+static bool rwlock_read_acquire(RWLock *r, struct RWLockSlot slot, uint32_t *value) {
+	atomic_fetch_or_64(slot.word, slot.bit, ATOMIC_SEQ_CST);
+
+	uint32_t state = atomic_load_32(&r->_state, ATOMIC_SEQ_CST);
+	if (builtin_expect(!(state & WRITE_PEND_BIT), true)) return true;
+
+	atomic_fetch_and_64(slot.word, ~slot.bit, ATOMIC_SEQ_CST);
+
+	// A writer which saw this thread in the set may be waiting for it to leave
+	if (!(state & WRITE_STATE_BIT)) rwlock_drained(r);
+
+	*value = state;
+	return false;
 }
 
-rcode rwlock_read_trylock(struct RWLock *r) {
-	return _rwlock_read_lock_base(r, true);
+rcode rwlock_init_sharded(RWLock *r, struct RWLockShard *shards, unsigned int count) {
+	if (!r || !shards) return DESCENT_ERROR_NULL;
+	if (!count || (uint64_t) count * 64 < THREAD_MAX) return DESCENT_ERROR_INVALID;
+
+	*r = (RWLock) RWLOCK_INIT;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		atomic_store_64(&shards[i]._readers, 0, ATOMIC_RELAXED);
+	}
+
+	r->_shards = shards;
+	r->_shard_count = count;
+
+	return 0;
 }
 
-rcode rwlock_read_unlock(struct RWLock *r) {
+rcode rwlock_read_lock(RWLock *r) {
 	if (!r) return DESCENT_ERROR_NULL;
 
-	// Writer bit is never set while any readers exist
-	if (thread_state != RWLOCK_READING) return DESCENT_ERROR_FORBIDDEN;
+	thread_id self = tid_self();
+	struct RWLockSlot slot = rwlock_reader_slot(r, self);
 
-	uint32_t state = atomic_fetch_sub_32(&r->_state, 1, ATOMIC_ACQ_REL);
+	rcode result = rwlock_check(r, self, slot);
+	if (result) return result;
 
-	uint32_t readers = state & MAXIMUM_READERS;
-	if (readers == 1u) {
-		futex_wake_all(&r->_state);
+	uint32_t value;
+	while (!rwlock_read_acquire(r, slot, &value)) {
+		result = futex_wait(&r->_state, value);
+		if (result) return result;
 	}
 
-	thread_state = RWLOCK_UNUSED;
 	return 0;
 }
 
-rcode rwlock_write_lock(struct RWLock *r) {
-	return _rwlock_write_lock_base(r, false);
-}
+rcode rwlock_read_trylock(RWLock *r) {
+	if (!r) return DESCENT_ERROR_NULL;
 
-rcode rwlock_write_trylock(struct RWLock *r) {
-	return _rwlock_write_lock_base(r, true);
-}
+	thread_id self = tid_self();
+	struct RWLockSlot slot = rwlock_reader_slot(r, self);
 
-rcode rwlock_downlock(struct RWLock *r) {
-	if (!r) return DESCENT_ERROR_NULL;
+	rcode result = rwlock_check(r, self, slot);
+	if (result) return result;
 
-	if (thread_state != RWLOCK_WRITING) return DESCENT_ERROR_FORBIDDEN;
+	// Fail early without touching the reader set
+	if (atomic_load_32(&r->_state, ATOMIC_RELAXED) & WRITE_PEND_BIT) return THREAD_INFO_BUSY;
 
-	// TODO
-	return DESCENT_ERROR_UNSUPPORTED;
+	uint32_t value;
+	return rwlock_read_acquire(r, slot, &value) ? 0 : THREAD_INFO_BUSY;
 }
 
-rcode rwlock_write_unlock(struct RWLock *r) {
+rcode rwlock_read_unlock(RWLock *r) {
 	if (!r) return DESCENT_ERROR_NULL;
 
-	if (thread_state != RWLOCK_WRITING) return DESCENT_ERROR_FORBIDDEN;
+	thread_id self = tid_self();
+	struct RWLockSlot slot = rwlock_reader_slot(r, self);
 
-	atomic_store_32(&r->_state, 0u, ATOMIC_RELEASE);
-	futex_wake_all(&r->_state);
+	if (!tid_is_managed(self) || !(atomic_load_64(slot.word, ATOMIC_RELAXED) & slot.bit)) return DESCENT_ERROR_FORBIDDEN;
+
+	atomic_fetch_and_64(slot.word, ~slot.bit, ATOMIC_SEQ_CST);
+
+	if (atomic_load_32(&r->_state, ATOMIC_SEQ_CST) & WRITE_PEND_BIT) rwlock_drained(r);
 
-	thread_state = RWLOCK_UNUSED;
 	return 0;
 }
 
-rcode mutex_lock(struct Mutex *m) {
-	if (!m) return DESCENT_ERROR_NULL;
+rcode rwlock_write_lock(RWLock *r) {
+	if (!r) return DESCENT_ERROR_NULL;
 
-	uint32_t expected = MUTEX_UNLOCKED;
-	if (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_LOCKED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE)) {
-		atomic_store_32(&m->_owner, ftid_self(), ATOMIC_RELEASE);
-		return 0;
-	}
+	thread_id self = tid_self();
 
-	if (atomic_load_32(&m->_owner, ATOMIC_ACQUIRE) == ftid_self()) return THREAD_ERROR_DEADLOCK;
+	rcode result = rwlock_check(r, self, rwlock_reader_slot(r, self));
+	if (result) return result;
 
-	do {
-		expected = MUTEX_LOCKED;
-		bool exchange = atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE);
+	atomic_fetch_add_32(&r->_pending, 1, ATOMIC_SEQ_CST);
 
-		if (exchange || expected == MUTEX_CONTENDED) {
-			futex_wait(&m->_state, MUTEX_CONTENDED);
+	for (;;) {
+		uint32_t state = atomic_load_32(&r->_state, ATOMIC_SEQ_CST);
+
+		// Keep new readers out. The bit may have been cleared by a writer
+		// which released the lock before seeing this one pending.
+		if (!(state & WRITE_PEND_BIT)) {
+			atomic_fetch_or_32(&r->_state, WRITE_PEND_BIT, ATOMIC_SEQ_CST);
+			continue;
+		}
+
+		if (state & WRITE_STATE_BIT) {
+			result = futex_wait(&r->_state, state);
+			if (result) break;
+			continue;
 		}
 
-		expected = MUTEX_UNLOCKED;
-	} while (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_CONTENDED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE));
+		uint32_t drain = atomic_load_32(&r->_drain, ATOMIC_SEQ_CST);
+		if (rwlock_has_readers(r)) {
+			result = futex_wait(&r->_drain, drain);
+			if (result) break;
+			continue;
+		}
+
+		if (atomic_compare_exchange_32(&r->_state, &state, WRITE_STATE_BIT | WRITE_PEND_BIT, ATOMIC_SEQ_CST, ATOMIC_RELAXED)) break;
+	}
+
+	atomic_fetch_sub_32(&r->_pending, 1, ATOMIC_SEQ_CST);
+	if (result) return result;
 
-	atomic_store_32(&m->_owner, ftid_self(), ATOMIC_RELEASE);
+	atomic_store_64(&r->_writer, self, ATOMIC_RELAXED);
 
 	return 0;
 }
 
-rcode mutex_trylock(struct Mutex *m) {
-	if (!m) return DESCENT_ERROR_NULL;
+rcode rwlock_write_trylock(RWLock *r) {
+	if (!r) return DESCENT_ERROR_NULL;
+
+	thread_id self = tid_self();
+
+	rcode result = rwlock_check(r, self, rwlock_reader_slot(r, self));
+	if (result) return result;
 
-	uint32_t expected = MUTEX_UNLOCKED;
-	if (atomic_compare_exchange_32(&m->_state, &expected, MUTEX_LOCKED, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE)) {
-		atomic_store_32(&m->_owner, ftid_self(), ATOMIC_RELEASE);
-		return 0;
+	uint32_t expected = 0;
+	if (!atomic_compare_exchange_32(&r->_state, &expected, WRITE_STATE_BIT | WRITE_PEND_BIT, ATOMIC_SEQ_CST, ATOMIC_RELAXED)) return THREAD_INFO_BUSY;
+
+	// Readers which joined before the bits were set still hold the lock
+	if (rwlock_has_readers(r)) {
+		rwlock_release_writer(r);
+		return THREAD_INFO_BUSY;
 	}
 
-	return DESCENT_WARN_BUSY;
+	atomic_store_64(&r->_writer, self, ATOMIC_RELAXED);
+
+	return 0;
 }
 
-rcode mutex_unlock(struct Mutex *m) {
-	if (!m) return DESCENT_ERROR_NULL;
+rcode rwlock_downlock(RWLock *r) {
+	if (!r) return DESCENT_ERROR_NULL;
 
-	// Only the owner can mutate the _owner field
-	uint32_t self = ftid_self();
-	if (!atomic_compare_exchange_32(&m->_owner, &self, FTID_NONE, ATOMIC_ACQ_REL, ATOMIC_ACQUIRE)) {
-		return DESCENT_ERROR_FORBIDDEN;
-	}
+	thread_id self = tid_self();
+	if (!tid_is_managed(self) || atomic_load_64(&r->_writer, ATOMIC_RELAXED) != self) return DESCENT_ERROR_FORBIDDEN;
 
-	if (atomic_fetch_sub_32(&m->_state, 1, ATOMIC_RELEASE)) {
-		atomic_store_32(&m->_state, 0, ATOMIC_RELEASE);
-		futex_wake_next(&m->_state);
-	}
+	// Join the readers before letting go, so no writer can get in between
+	struct RWLockSlot slot = rwlock_reader_slot(r, self);
+	atomic_fetch_or_64(slot.word, slot.bit, ATOMIC_SEQ_CST);
+	atomic_store_64(&r->_writer, TID_NONE, ATOMIC_RELAXED);
+
+	rwlock_release_writer(r);
 
 	return 0;
 }
 
-rcode mutex_wait(struct Mutex *m, struct Condition *c) {
-	if (!m || !c) return DESCENT_ERROR_NULL;
+rcode rwlock_write_unlock(RWLock *r) {
+	if (!r) return DESCENT_ERROR_NULL;
+
+	thread_id self = tid_self();
+	if (!tid_is_managed(self) || atomic_load_64(&r->_writer, ATOMIC_RELAXED) != self) return DESCENT_ERROR_FORBIDDEN;
 
-	uint32_t expected = atomic_load_32(&c->_generation, ATOMIC_RELAXED);
-	
-	rcode result = mutex_unlock(m);
-	if (result) return result;
+	atomic_store_64(&r->_writer, TID_NONE, ATOMIC_RELAXED);
 
-	futex_wait(&c->_generation, expected);
+	rwlock_release_writer(r);
 
-	return mutex_lock(m);
-}
\ No newline at end of file
+	return 0;
+}
@@ -22,9 +22,33 @@
 #include <descent/thread/atomic.h>
 #include <descent/thread/condition.h>
 #include <descent/thread/futex.h>
+#include <intern/thread/hints.h>
+#include <intern/thread/spin.h>
+
+// Spins while a signal is likely to arrive soon
+static bool semaphore_spin(struct Semaphore *s) {
+	uint32_t limit = spin_limit(&s->_spin);
+
+	for (uint32_t spins = 0; spins < limit; ++spins) {
+		thread_spin_hint();
+
+		uint32_t count = atomic_load_32(&s->_count, ATOMIC_RELAXED);
+		if (!count) continue;
+
+		if (atomic_compare_exchange_32(&s->_count, &count, count - 1, ATOMIC_ACQUIRE, ATOMIC_RELAXED)) {
+			spin_learn(&s->_spin, spins, true);
+			return true;
+		}
+	}
+
+	spin_learn(&s->_spin, limit, false);
+	return false;
+}
 
 int semaphore_wait(struct Semaphore *s) {
 	if (!s) return DESCENT_ERROR_NULL;
+
+	bool spun = false;
 	
 	for (;;)  {
 		uint32_t count = atomic_load_32(&s->_count, ATOMIC_RELAXED);
@@ -35,6 +59,11 @@ int semaphore_wait(struct Semaphore *s) {
 			}
 		}
 
+		else if (!spun) {
+			spun = true;
+			if (semaphore_spin(s)) return 0;
+		}
+
 		else {
 			rcode result = futex_wait(&s->_count, 0);
 			if (result) return result;
@@ -0,0 +1,163 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/seqlock.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <descent/utilities/builtin.h>
+#include <intern/thread/hints.h>
+#include <intern/thread/spin.h>
+
+// The sequence advances by SEQUENCE_STEP per write. Its low bits mark a write
+// in progress, and threads parked until that write ends.
+
+#define SEQUENCE_WRITING 1u
+#define SEQUENCE_WAITERS 2u
+#define SEQUENCE_STEP    4u
+
+// Waits for the write in progress to end, spinning first since writes are
+// expected to be short. Only parking writes to the lock.
+static uint32_t seqlock_wait(struct SeqLock *s, uint32_t sequence) {
+	for (uint32_t spins = 0; spins < DESCENT_SPIN_LIMIT; ++spins) {
+		thread_spin_hint();
+
+		sequence = atomic_load_32(&s->_sequence, ATOMIC_ACQUIRE);
+		if (!(sequence & SEQUENCE_WRITING)) return sequence;
+	}
+
+	while (sequence & SEQUENCE_WRITING) {
+		if (!(sequence & SEQUENCE_WAITERS)) {
+			if (!atomic_compare_exchange_32(&s->_sequence, &sequence, sequence | SEQUENCE_WAITERS, ATOMIC_RELAXED, ATOMIC_ACQUIRE)) continue;
+			sequence |= SEQUENCE_WAITERS;
+		}
+
+		futex_wait(&s->_sequence, sequence);
+		sequence = atomic_load_32(&s->_sequence, ATOMIC_ACQUIRE);
+	}
+
+	return sequence;
+}
+
+// Shared data is copied with relaxed atomics, a word at a time where
+// alignment allows, so that racing with a writer is well-defined
+static void seqlock_copy_from(void *data, const void *shared, size_t size) {
+	unsigned char *d = data;
+	const unsigned char *s = shared;
+
+	if (!(((uintptr_t) d | (uintptr_t) s) & (sizeof(uint64_t) - 1))) {
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+			uint64_t word = __atomic_load_n((const uint64_t *) (const void *) s, __ATOMIC_RELAXED);
+			memcpy(d, &word, sizeof(word));
+			d += sizeof(uint64_t);
+			s += sizeof(uint64_t);
+		}
+	}
+
+	for (; size; --size) *d++ = __atomic_load_n(s++, __ATOMIC_RELAXED);
+}
+
+static void seqlock_copy_to(void *shared, const void *data, size_t size) {
+	unsigned char *d = shared;
+	const unsigned char *s = data;
+
+	if (!(((uintptr_t) d | (uintptr_t) s) & (sizeof(uint64_t) - 1))) {
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+			uint64_t word;
+			memcpy(&word, s, sizeof(word));
+			__atomic_store_n((uint64_t *) (void *) d, word, __ATOMIC_RELAXED);
+			d += sizeof(uint64_t);
+			s += sizeof(uint64_t);
+		}
+	}
+
+	for (; size; --size) __atomic_store_n(d++, *s++, __ATOMIC_RELAXED);
+}
+
+rcode seqlock_read_begin(struct SeqLock *s, uint32_t *sequence) {
+	if (!s || !sequence) return DESCENT_ERROR_NULL;
+
+	uint32_t value = atomic_load_32(&s->_sequence, ATOMIC_ACQUIRE);
+	if (builtin_expect(value & SEQUENCE_WRITING, false)) value = seqlock_wait(s, value);
+
+	*sequence = value & ~SEQUENCE_WAITERS;
+	return 0;
+}
+
+bool seqlock_read_retry(struct SeqLock *s, uint32_t sequence) {
+	// Orders the reads of the data before the second read of the sequence
+	atomic_thread_fence(ATOMIC_ACQUIRE);
+	return (atomic_load_32(&s->_sequence, ATOMIC_RELAXED) & ~SEQUENCE_WAITERS) != sequence;
+}
+
+rcode seqlock_write_begin(struct SeqLock *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	uint32_t sequence = atomic_load_32(&s->_sequence, ATOMIC_RELAXED);
+
+	for (;;) {
+		if (sequence & SEQUENCE_WRITING) {
+			sequence = seqlock_wait(s, sequence);
+			continue;
+		}
+
+		if (atomic_compare_exchange_32(&s->_sequence, &sequence, sequence | SEQUENCE_WRITING, ATOMIC_ACQUIRE, ATOMIC_RELAXED)) break;
+	}
+
+	// Orders the odd sequence before the writes to the data
+	atomic_thread_fence(ATOMIC_RELEASE);
+
+	return 0;
+}
+
+rcode seqlock_write_end(struct SeqLock *s) {
+	if (!s) return DESCENT_ERROR_NULL;
+
+	uint32_t sequence = atomic_load_32(&s->_sequence, ATOMIC_RELAXED);
+	if (!(sequence & SEQUENCE_WRITING)) return DESCENT_ERROR_STATE;
+
+	uint32_t next = (sequence & ~(SEQUENCE_WRITING | SEQUENCE_WAITERS)) + SEQUENCE_STEP;
+	sequence = atomic_exchange_32(&s->_sequence, next, ATOMIC_RELEASE);
+
+	if (sequence & SEQUENCE_WAITERS) futex_wake_all(&s->_sequence);
+
+	return 0;
+}
+
+rcode seqlock_read(struct SeqLock *s, void *data, const void *shared, size_t size) {
+	if (!s || !data || !shared) return DESCENT_ERROR_NULL;
+
+	uint32_t sequence;
+	do {
+		seqlock_read_begin(s, &sequence);
+		seqlock_copy_from(data, shared, size);
+	} while (seqlock_read_retry(s, sequence));
+
+	return 0;
+}
+
+rcode seqlock_write(struct SeqLock *s, void *shared, const void *data, size_t size) {
+	if (!s || !shared || !data) return DESCENT_ERROR_NULL;
+
+	seqlock_write_begin(s);
+	seqlock_copy_to(shared, data, size);
+	return seqlock_write_end(s);
+}
@@ -26,6 +26,10 @@
 
 #if defined(DESCENT_PLATFORM_TYPE_POSIX)
 #include <pthread.h>
+#if defined(DESCENT_PLATFORM_FREEBSD)
+#include <pthread_np.h>
+#include <sys/cpuset.h>
+#endif
 #elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -36,6 +40,7 @@
 #include <descent/string/utf_8.h>
 #include <descent/thread/atomic.h>
 #include <descent/thread/tls.h>
+#include <descent/thread/topology.h>
 #include <intern/thread/call_once_u.h>
 #include <intern/thread/tid.h>
 
@@ -50,19 +55,24 @@ typedef HANDLE thread_handle;
 #endif
 
 struct Thread {
-	thread_handle handle;
-	nchar         name[DESCENT_THREAD_NAME_SIZE];
-	int         (*function)(void *);
-	void         *argument;
-	thread_id     id;
-	atomic_int    state;
-	atomic_int    code;
+	thread_handle  handle;
+	nchar          name[DESCENT_THREAD_NAME_SIZE];
+	int          (*function)(void *);
+	void          *argument;
+	thread_id      id;
+	struct CpuMask affinity;
+	atomic_int     state;
+	atomic_int     code;
 };
 
 static struct Thread unique[DESCENT_UNIQUE_THREAD_COUNT_MAX] = {0};
 static struct Thread worker[DESCENT_WORKER_THREAD_COUNT_MAX] = {0};
 static unsigned int worker_count = 0;
 
+// Function and argument of the current batch, which growing it must match
+static int (*worker_function)(void *) = NULL;
+static void *worker_argument = NULL;
+
 static inline rcode thread_set_name(const nchar *name) {
 #if defined(DESCENT_PLATFORM_TYPE_POSIX)
 	// Supported on Linux and FreeBSD, our only two POSIX targets
@@ -73,12 +83,42 @@ static inline rcode thread_set_name(const nchar *name) {
 	return result ? DESCENT_ERROR_OS : 0;
 }
 
+static inline rcode thread_set_affinity(const struct CpuMask *affinity) {
+#if defined(DESCENT_PLATFORM_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (unsigned int cpu = cpu_mask_next(affinity, 0); cpu < DESCENT_TOPOLOGY_CPU_MAX; cpu = cpu_mask_next(affinity, cpu + 1)) {
+		if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+	}
+	int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(DESCENT_PLATFORM_FREEBSD)
+	cpuset_t set;
+	CPU_ZERO(&set);
+	for (unsigned int cpu = cpu_mask_next(affinity, 0); cpu < DESCENT_TOPOLOGY_CPU_MAX; cpu = cpu_mask_next(affinity, cpu + 1)) {
+		if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+	}
+	int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+	// A thread can only be pinned within one processor group, so use the group
+	// of the lowest CPU
+	unsigned int first = cpu_mask_next(affinity, 0);
+	GROUP_AFFINITY group = {0};
+	group.Group = (WORD) (first / 64u);
+	group.Mask = (KAFFINITY) affinity->_bits[first / 64u];
+	int result = !SetThreadGroupAffinity(GetCurrentThread(), &group, NULL);
+#endif
+	return result ? DESCENT_ERROR_OS : 0;
+}
+
 static THREAD_WRAPPER_SIGNATURE thread_wrapper(void *p) {
 	struct Thread *thread = (struct Thread *)p;
 
 	// We don't particularly care if thread naming fails
 	(void) thread_set_name(thread->name);
 
+	// Nor if pinning fails, since the thread still runs correctly unpinned
+	if (!cpu_mask_is_empty(&thread->affinity)) (void) thread_set_affinity(&thread->affinity);
+
 	// We do care if a TID assignment fails, since it's necessary for a lot of
 	// library operations
 	rcode tid_result = tid_assign(thread->id);
@@ -94,6 +134,9 @@ static THREAD_WRAPPER_SIGNATURE thread_wrapper(void *p) {
 	// Run provided function
 	int result = thread->function(thread->argument);
 
+	// Release the TID so that the slot can be spawned again
+	tid_assign_clear();
+
 	// Mark thread as complete
 	atomic_store_int(&thread->code, result, ATOMIC_RELEASE);
 	atomic_store_int(&thread->state, THREAD_STATE_FINISHED, ATOMIC_RELEASE);
@@ -106,6 +149,7 @@ static inline rcode thread_spawn(
 	int (*function)(void *),
 	void *argument,
 	const char *name,
+	const struct CpuMask *affinity,
 	thread_id id
 ) {
 	if (!thread || !function) return DESCENT_ERROR_NULL;
@@ -135,6 +179,7 @@ static inline rcode thread_spawn(
 	thread->function = function;
 	thread->argument = argument;
 	thread->id       = id;
+	thread->affinity = affinity ? *affinity : (struct CpuMask) CPU_MASK_INIT;
 	
 	atomic_store_int(&thread->state, THREAD_STATE_STARTING, ATOMIC_RELEASE);
 	atomic_store_int(&thread->code, 0, ATOMIC_RELEASE);
@@ -219,9 +264,9 @@ unsigned int thread_worker_max(void) {
 	return DESCENT_WORKER_THREAD_COUNT_MAX;
 }
 
-rcode thread_spawn_unique(unsigned int id, int (*function)(void *), void *argument, const char *name) {
+rcode thread_spawn_unique(unsigned int id, int (*function)(void *), void *argument, const char *name, const struct CpuMask *affinity) {
 	if (id >= DESCENT_UNIQUE_THREAD_COUNT_MAX) return DESCENT_ERROR_FORBIDDEN;
-	return thread_spawn(&unique[id], function, argument, name, tid_generate_unique(id));
+	return thread_spawn(&unique[id], function, argument, name, affinity, tid_generate_unique(id));
 }
 
 rcode thread_collect_unique(unsigned int id) {
@@ -239,32 +284,46 @@ int thread_code_unique(unsigned int id) {
 	return thread_code(&unique[id]);
 }
 
-rcode thread_spawn_worker(unsigned int count, int (*function)(void *), void *argument) {
+rcode thread_spawn_worker(unsigned int count, int (*function)(void *), void *argument, const struct CpuMask *affinity) {
 	// Only the main thread has permission to call this function
 	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
 
 	if (count > DESCENT_WORKER_THREAD_COUNT_MAX) return THREAD_ERROR_INVALID;
 
-	// Check if workers are already active
-	if (worker_count) return THREAD_ERROR_ACTIVE;
-	
-	// Update worker count
+	// An existing batch can only be grown, and only with the same function
+	if (worker_count) {
+		if (count < worker_count || function != worker_function || argument != worker_argument) return THREAD_ERROR_ACTIVE;
+	}
+
 	worker_count = count;
+	worker_function = function;
+	worker_argument = argument;
 
 	int result = 0;
 	nchar name[DESCENT_THREAD_NAME_SIZE];
 	
-	// Try to create all threads
+	// Try to create all threads which are not already active
 	for (unsigned int i = 0; i < count; ++i) {
+		switch (atomic_load_int(&worker[i].state, ATOMIC_ACQUIRE)) {
+			case THREAD_STATE_STARTING:
+			case THREAD_STATE_RUNNING:
+			case THREAD_STATE_FINISHED:
+				continue;
+		}
+
 		nchars_format(DESCENT_THREAD_NAME_SIZE, name, "D-WORKER %u", i);
 		
-		int worker_result = thread_spawn(&worker[i], function, argument, name, tid_generate_worker(i));
+		int worker_result = thread_spawn(&worker[i], function, argument, name, affinity ? &affinity[i] : NULL, tid_generate_worker(i));
 		if (worker_result) result = DESCENT_WARN_INCOMPLETE;
 	}
 
 	return result;
 }
 
+unsigned int thread_worker_count(void) {
+	return worker_count;
+}
+
 rcode thread_collect_worker(void) {
 	// Only the main thread has permission to call this function
 	if (!tid_is_self(TID_MAIN)) return DESCENT_ERROR_FORBIDDEN;
@@ -281,7 +340,11 @@ rcode thread_collect_worker(void) {
 	}
 
 	// Update worker count
-	if (!result) worker_count = 0;
+	if (!result) {
+		worker_count = 0;
+		worker_function = NULL;
+		worker_argument = NULL;
+	}
 
 	return result;
 }
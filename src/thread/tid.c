@@ -21,15 +21,14 @@
 
 static TLS thread_id self = TID_NONE;
 
-static atomic_64 assigned_tid_set = {0};
+static thread_id_atomic_set assigned_tid_set = {0};
 
 static inline rcode tid_assign_checked(thread_id t) {
 	if (self != TID_NONE) return DESCENT_ERROR_INIT;
-	thread_id_set previous = atomic_fetch_or_64(&assigned_tid_set, t, ATOMIC_RELEASE);
 	// If a collision is detected, the bit was already set for another thread.
 	// Clearing it would artificially indicate that it is not held by that other
 	// thread, so we do not revert.
-	if (t & previous) return DESCENT_ERROR_STATE;
+	if (tid_atomic_set_add(&assigned_tid_set, t, ATOMIC_RELEASE)) return DESCENT_ERROR_STATE;
 	self = t;
 	return 0;
 }
@@ -43,12 +42,11 @@ bool tid_is_self(thread_id t) {
 }
 
 bool tid_is_assigned(thread_id t) {
-	thread_id_set assigned = atomic_load_64(&assigned_tid_set, ATOMIC_ACQUIRE);
-	return (t & assigned) && !(t & (t - 1));
+	return tid_atomic_set_contains(&assigned_tid_set, t, ATOMIC_ACQUIRE);
 }
 
 rcode tid_assign(thread_id t) {
-	if (t == TID_NONE) return DESCENT_ERROR_INVALID;
+	if (!tid_is_managed(t)) return DESCENT_ERROR_INVALID;
 	return tid_assign_checked(t);
 }
 
@@ -67,7 +65,7 @@ rcode tid_assign_worker(unsigned int index) {
 }
 
 void tid_assign_clear(void) {
-	atomic_fetch_and_64(&assigned_tid_set, ~self, ATOMIC_RELEASE);
+	tid_atomic_set_remove(&assigned_tid_set, self, ATOMIC_RELEASE);
 	self = TID_NONE;
 }
 
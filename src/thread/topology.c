@@ -0,0 +1,138 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/utilities/platform.h>
+
+// Each platform fills in the online CPUs in ascending order, with an
+// arbitrary key for each domain which is shared by exactly the CPUs in that
+// domain. The keys are then renumbered densely.
+
+#if defined(DESCENT_PLATFORM_LINUX)
+#include "topology/linux.ic"
+#elif defined(DESCENT_PLATFORM_TYPE_WINDOWS)
+#include "topology/windows.ic"
+#else
+#include "topology/generic.ic"
+#endif
+
+#include <descent/thread/topology.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <intern/thread/call_once_u.h>
+
+static struct Topology topology = {0};
+static rcode topology_result = 0;
+static struct CallOnce_u topology_once = CALL_ONCE_U_INIT;
+
+// Replaces the keys of one domain with dense indices, in order of each
+// domain's lowest CPU
+static void topology_renumber(struct Topology *t, unsigned int domain) {
+	unsigned int keys[DESCENT_TOPOLOGY_CPU_MAX];
+	unsigned int count = 0;
+
+	for (unsigned int i = 0; i < t->cpu_count; ++i) {
+		unsigned int key = t->cpus[i].domain[domain];
+
+		unsigned int index = 0;
+		while (index < count && keys[index] != key) ++index;
+		if (index == count) keys[count++] = key;
+
+		t->cpus[i].domain[domain] = index;
+	}
+
+	t->domain_count[domain] = count;
+}
+
+static void topology_discover(void) {
+	topology_result = topology_platform_read(&topology);
+	if (topology_result) return;
+
+	if (!topology.cpu_count) {
+		topology_result = DESCENT_ERROR_OS;
+		return;
+	}
+
+	for (unsigned int d = 0; d < TOPOLOGY_DOMAIN_COUNT; ++d) topology_renumber(&topology, d);
+
+	// SMT siblings are numbered in order of their OS CPU number
+	for (unsigned int i = 0; i < topology.cpu_count; ++i) {
+		unsigned int smt = 0;
+		for (unsigned int j = 0; j < i; ++j) {
+			if (topology.cpus[j].domain[TOPOLOGY_DOMAIN_CORE] == topology.cpus[i].domain[TOPOLOGY_DOMAIN_CORE]) ++smt;
+		}
+		topology.cpus[i].smt = smt;
+	}
+}
+
+rcode topology_query(const struct Topology **t) {
+	if (!t) return DESCENT_ERROR_NULL;
+
+	call_once_u(&topology_once, topology_discover);
+	if (topology_result) return topology_result;
+
+	*t = &topology;
+	return 0;
+}
+
+rcode topology_mask(TopologyDomain domain, unsigned int index, struct CpuMask *mask) {
+	if (!mask) return DESCENT_ERROR_NULL;
+	if ((unsigned int) domain >= TOPOLOGY_DOMAIN_COUNT) return DESCENT_ERROR_INVALID;
+
+	const struct Topology *t;
+	rcode result = topology_query(&t);
+	if (result) return result;
+
+	if (index >= t->domain_count[domain]) return DESCENT_ERROR_INVALID;
+
+	*mask = (struct CpuMask) CPU_MASK_INIT;
+	for (unsigned int i = 0; i < t->cpu_count; ++i) {
+		if (t->cpus[i].domain[domain] == index) cpu_mask_add(mask, t->cpus[i].id);
+	}
+
+	return 0;
+}
+
+rcode topology_core_affinity(struct CpuMask *affinity, unsigned int count, unsigned int *written) {
+	if (!affinity || !written) return DESCENT_ERROR_NULL;
+
+	const struct Topology *t;
+	rcode result = topology_query(&t);
+	if (result) return result;
+
+	// Cores do not span caches, so each core's cache is that of any of its CPUs
+	unsigned int core_cache[DESCENT_TOPOLOGY_CPU_MAX];
+	for (unsigned int i = 0; i < t->cpu_count; ++i) {
+		core_cache[t->cpus[i].domain[TOPOLOGY_DOMAIN_CORE]] = t->cpus[i].domain[TOPOLOGY_DOMAIN_CACHE];
+	}
+
+	unsigned int cores = t->domain_count[TOPOLOGY_DOMAIN_CORE];
+	unsigned int n = 0;
+
+	for (unsigned int cache = 0; cache < t->domain_count[TOPOLOGY_DOMAIN_CACHE] && n < count; ++cache) {
+		for (unsigned int core = 0; core < cores && n < count; ++core) {
+			if (core_cache[core] != cache) continue;
+
+			result = topology_mask(TOPOLOGY_DOMAIN_CORE, core, &affinity[n]);
+			if (result) return result;
+			++n;
+		}
+	}
+
+	*written = n;
+	return 0;
+}
@@ -0,0 +1,151 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <descent/thread/wait.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/condition.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/job.h>
+#include <descent/thread/semaphore.h>
+#include <descent/time.h>
+#include <intern/thread/job.h>
+
+_Static_assert(WAIT_ANY_MAX <= FUTEX_WAIT_ANY_MAX, "WAIT_ANY_MAX must not exceed FUTEX_WAIT_ANY_MAX");
+
+// Checks whether an object is ready, acquiring it if it is a semaphore.
+// Otherwise, fills in the futex to wait on.
+static bool wait_ready(struct WaitObject *w, struct FutexWaiter *waiter) {
+	switch (w->type) {
+		case WAIT_TYPE_SEMAPHORE: {
+			struct Semaphore *s = w->object;
+			if (!semaphore_trywait(s)) return true;
+
+			*waiter = (struct FutexWaiter) {.futex = &s->_count, .expected = 0};
+			return false;
+		}
+
+		case WAIT_TYPE_CONDITION: {
+			// Read before the generation, so any signal after the check
+			// changes it
+			struct Condition *c = w->object;
+			uint32_t any = atomic_load_32(&c->_any, ATOMIC_SEQ_CST);
+			if (atomic_load_32(&c->_generation, ATOMIC_SEQ_CST) != w->_generation) return true;
+
+			*waiter = (struct FutexWaiter) {.futex = &c->_any, .expected = any};
+			return false;
+		}
+
+		case WAIT_TYPE_JOB_COUNTER:
+		default: {
+			atomic_32 *futex;
+			uint32_t expected;
+			if (!job_counter_park(w->object, &futex, &expected)) return true;
+
+			*waiter = (struct FutexWaiter) {.futex = futex, .expected = expected};
+			return false;
+		}
+	}
+}
+
+// A semaphore signal wakes a single thread, which may have been this one. If
+// this thread took another object instead, the wake is passed on.
+static void wait_pass_on(struct WaitObject *objects, unsigned int count, unsigned int taken) {
+	for (unsigned int i = 0; i < count; ++i) {
+		if (i == taken || objects[i].type != WAIT_TYPE_SEMAPHORE) continue;
+
+		struct Semaphore *s = objects[i].object;
+		if (atomic_load_32(&s->_count, ATOMIC_RELAXED)) futex_wake_next(&s->_count);
+	}
+}
+
+// Registers or unregisters this thread as waiting on each condition
+static void wait_register(struct WaitObject *objects, unsigned int count, bool waiting) {
+	for (unsigned int i = 0; i < count; ++i) {
+		if (objects[i].type != WAIT_TYPE_CONDITION) continue;
+
+		struct Condition *c = objects[i].object;
+		if (waiting) atomic_fetch_add_32(&c->_any_waiters, 1, ATOMIC_SEQ_CST);
+		else atomic_fetch_sub_32(&c->_any_waiters, 1, ATOMIC_RELAXED);
+	}
+}
+
+static rcode wait_objects(struct WaitObject *objects, unsigned int count, unsigned int *index, const uint64_t *nanoseconds) {
+	if (!objects) return DESCENT_ERROR_NULL;
+	if (!count || count > WAIT_ANY_MAX) return DESCENT_ERROR_INVALID;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (!objects[i].object) return DESCENT_ERROR_NULL;
+		if ((unsigned int) objects[i].type > WAIT_TYPE_JOB_COUNTER) return DESCENT_ERROR_INVALID;
+	}
+
+	struct FutexWaiter waiters[WAIT_ANY_MAX];
+	uint64_t start = nanoseconds ? time_nanoseconds() : 0;
+	bool slept = false;
+	rcode result = 0;
+
+	wait_register(objects, count, true);
+
+	for (;;) {
+		for (unsigned int i = 0; i < count; ++i) {
+			if (!wait_ready(&objects[i], &waiters[i])) continue;
+
+			wait_register(objects, count, false);
+			if (slept) wait_pass_on(objects, count, i);
+			if (index) *index = i;
+			return 0;
+		}
+
+		// Checked after a final look at the objects
+		if (result == THREAD_INFO_TIMEOUT) break;
+
+		if (nanoseconds) {
+			uint64_t elapsed = time_nanoseconds() - start;
+			result = elapsed < *nanoseconds ? futex_timedwait_any(waiters, count, *nanoseconds - elapsed) : THREAD_INFO_TIMEOUT;
+		} else {
+			result = futex_wait_any(waiters, count);
+		}
+
+		if (result && result != THREAD_INFO_TIMEOUT) break;
+		slept = true;
+	}
+
+	wait_register(objects, count, false);
+	return result;
+}
+
+rcode wait_condition(struct WaitObject *w, struct Condition *c) {
+	if (!w || !c) return DESCENT_ERROR_NULL;
+
+	*w = (struct WaitObject) {
+		.type        = WAIT_TYPE_CONDITION,
+		.object      = c,
+		._generation = atomic_load_32(&c->_generation, ATOMIC_ACQUIRE),
+	};
+
+	return 0;
+}
+
+rcode wait_any(struct WaitObject *objects, unsigned int count, unsigned int *index) {
+	return wait_objects(objects, count, index, NULL);
+}
+
+rcode wait_any_timed(struct WaitObject *objects, unsigned int count, unsigned int *index, uint64_t nanoseconds) {
+	return wait_objects(objects, count, index, &nanoseconds);
+}
@@ -0,0 +1,129 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs threads in lockstep through many phases of one barrier. Threads take
+// turns arriving late, so that the others park. Checks that no thread starts a
+// phase before every thread has finished the previous one, and that the
+// completion function runs exactly once per phase, after every thread has
+// arrived and before any is released.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/barrier.h>
+#include <descent/thread/thread.h>
+#include <descent/time.h>
+
+#define TEST_THREADS 6
+#define TEST_PHASES  2000
+
+// The late thread of a phase arrives this many nanoseconds after the others,
+// once every TEST_LATE_INTERVAL phases
+#define TEST_LATE_INTERVAL 16
+#define TEST_LATE          100000
+
+static void complete(void *argument);
+
+static struct Barrier barrier = BARRIER_INIT_COMPLETION(TEST_THREADS, complete, &barrier);
+
+static atomic_32 next_thread = ATOMIC_INIT(0);
+static atomic_32 failed = ATOMIC_INIT(0);
+static atomic_32 arrived = ATOMIC_INIT(0);
+static atomic_32 completions = ATOMIC_INIT(0);
+static atomic_32 completing = ATOMIC_INIT(0);
+
+static void fail(const char *what) {
+	printf("%s\n", what);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static void complete(void *argument) {
+	if (argument != &barrier) fail("The completion function got the wrong argument");
+	if (atomic_exchange_32(&completing, 1, ATOMIC_ACQUIRE)) fail("The completion function ran twice at once");
+
+	uint32_t phase = atomic_load_32(&completions, ATOMIC_RELAXED);
+	if (atomic_load_32(&arrived, ATOMIC_RELAXED) != (phase + 1) * TEST_THREADS) fail("The completion function ran before every thread arrived");
+
+	atomic_store_32(&completions, phase + 1, ATOMIC_RELAXED);
+	atomic_store_32(&completing, 0, ATOMIC_RELEASE);
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next_thread, 1, ATOMIC_RELAXED);
+
+	for (uint32_t phase = 0; phase < TEST_PHASES; ++phase) {
+		if (atomic_load_32(&completions, ATOMIC_RELAXED) != phase) {
+			fail("A thread started a phase before the previous one completed");
+			return 1;
+		}
+
+		if (phase % TEST_LATE_INTERVAL == 0 && (phase / TEST_LATE_INTERVAL) % TEST_THREADS == index) {
+			uint64_t start = time_nanoseconds();
+			while (time_nanoseconds() - start < TEST_LATE);
+		}
+
+		atomic_fetch_add_32(&arrived, 1, ATOMIC_RELAXED);
+
+		rcode result = barrier_wait(&barrier);
+		if (result) {
+			printf("barrier_wait() returned %s (%d)\n", rcode_string(result), result);
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+			return 1;
+		}
+
+		if (atomic_load_32(&completions, ATOMIC_RELAXED) != phase + 1) {
+			fail("A thread was released before the completion function ran");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+
+	if (thread_spawn_worker(TEST_THREADS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	uint32_t total = atomic_load_32(&completions, ATOMIC_RELAXED);
+	if (total != TEST_PHASES) {
+		printf("The completion function ran %u times over %u phases\n", total, TEST_PHASES);
+		return -1;
+	}
+
+	// A barrier of one thread never waits
+	struct Barrier single;
+	if (barrier_init(&single, 1, NULL, NULL) || barrier_wait(&single) || barrier_wait(&single)) {
+		printf("A barrier of one thread did not release it\n");
+		return -1;
+	}
+
+	if (barrier_init(&single, 0, NULL, NULL) != DESCENT_ERROR_INVALID) {
+		printf("barrier_init() accepted a count of 0\n");
+		return -1;
+	}
+
+	printf("%u phases completed\n", total);
+	return 0;
+}
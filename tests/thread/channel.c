@@ -0,0 +1,171 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Streams messages through a small channel in batches whose sizes do not
+// divide its capacity, so that pushes and pops are cut short and wrap around
+// the end of the buffer. In one phase the consumer is slow, so the producer
+// sleeps on the doorbell for space, and in the other the producer is slow, so
+// the consumer sleeps for messages. Checks that every message arrives intact
+// and in order.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/channel.h>
+#include <descent/thread/thread.h>
+#include <descent/time.h>
+
+#define TEST_CAPACITY   8
+#define TEST_MESSAGES   100000
+#define TEST_PUSH_BATCH 11
+#define TEST_POP_BATCH  13
+
+// The slow side of each phase pauses once every TEST_PAUSE_INTERVAL messages
+#define TEST_PAUSE_INTERVAL 512
+#define TEST_PAUSE          20000
+
+struct TestMessage {
+	uint32_t sequence;
+	uint32_t check;
+};
+
+static struct TestMessage buffer[TEST_CAPACITY];
+static struct Channel     channel;
+
+static atomic_32 next_thread = ATOMIC_INIT(0);
+static atomic_32 failed = ATOMIC_INIT(0);
+
+// The consumer is slow for the first half of the messages, and the producer
+// for the second
+static bool slow_consumer(uint32_t sequence) {
+	return sequence < TEST_MESSAGES / 2;
+}
+
+static void stall(uint32_t sequence) {
+	if (sequence % TEST_PAUSE_INTERVAL) return;
+
+	uint64_t start = time_nanoseconds();
+	while (time_nanoseconds() - start < TEST_PAUSE);
+}
+
+static void fail(const char *what, rcode result) {
+	printf("%s returned %s (%d)\n", what, rcode_string(result), result);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static int producer(void) {
+	struct TestMessage batch[TEST_PUSH_BATCH];
+	uint32_t next = 0;
+
+	for (unsigned int round = 0; next < TEST_MESSAGES; ++round) {
+		size_t count = round % TEST_PUSH_BATCH + 1;
+		if (count > TEST_MESSAGES - next) count = TEST_MESSAGES - next;
+
+		for (size_t i = 0; i < count; ++i) {
+			uint32_t sequence = next + (uint32_t) i;
+			batch[i] = (struct TestMessage) {.sequence = sequence, .check = ~sequence};
+		}
+
+		for (size_t pushed = 0; pushed < count;) {
+			size_t n = channel_push(&channel, &batch[pushed], count - pushed);
+			pushed += n;
+
+			if (!n) {
+				rcode result = channel_wait_space(&channel);
+				if (result) {
+					fail("channel_wait_space()", result);
+					return 1;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			if (!slow_consumer(next)) stall(next);
+			++next;
+		}
+	}
+
+	return 0;
+}
+
+static int consumer(void) {
+	struct TestMessage batch[TEST_POP_BATCH];
+	uint32_t expected = 0;
+
+	for (unsigned int round = 0; expected < TEST_MESSAGES; ++round) {
+		size_t n = channel_pop(&channel, batch, round % TEST_POP_BATCH + 1);
+
+		if (!n) {
+			rcode result = channel_wait(&channel);
+			if (result) {
+				fail("channel_wait()", result);
+				return 1;
+			}
+			continue;
+		}
+
+		for (size_t i = 0; i < n; ++i) {
+			if (batch[i].sequence != expected || batch[i].check != ~expected) {
+				printf("Expected message %u, but got %u (check %08x)\n", expected, batch[i].sequence, batch[i].check);
+				atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+				return 1;
+			}
+
+			if (slow_consumer(expected)) stall(expected);
+			++expected;
+		}
+	}
+
+	return 0;
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	if (atomic_fetch_add_32(&next_thread, 1, ATOMIC_RELAXED)) return consumer();
+	return producer();
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+
+	// Waiting is refused without a doorbell
+	if (channel_init(&channel, buffer, sizeof(buffer[0]), TEST_CAPACITY, false)) return -1;
+	if (channel_wait(&channel) != DESCENT_ERROR_STATE || channel_wait_space(&channel) != DESCENT_ERROR_STATE) {
+		printf("A channel without a doorbell allowed waiting\n");
+		return -1;
+	}
+
+	if (channel_init(&channel, buffer, sizeof(buffer[0]), TEST_CAPACITY, true)) return -1;
+
+	if (thread_spawn_worker(2, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	struct TestMessage extra;
+	if (channel_pop(&channel, &extra, 1)) {
+		printf("The channel was not left empty\n");
+		return -1;
+	}
+
+	printf("%u messages passed through %u slots\n", TEST_MESSAGES, TEST_CAPACITY);
+	return 0;
+}
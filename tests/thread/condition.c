@@ -0,0 +1,184 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Mixes threads waiting on one condition with mutex_wait() and wait_any(), and
+// checks that every broadcast reaches all of them. A broadcast moves mutex
+// waiters onto the mutex, which must not take the multi-waiters along.
+//
+// Then has threads wait on one condition with different mutexes, which a
+// broadcast must not move onto a mutex other than their own.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/condition.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/mutex.h>
+#include <descent/thread/thread.h>
+#include <descent/thread/wait.h>
+
+#define TEST_MUTEX_WAITERS 4
+#define TEST_ANY_WAITERS   4
+#define TEST_WAITERS       (TEST_MUTEX_WAITERS + TEST_ANY_WAITERS)
+#define TEST_ROUNDS        2000
+#define TEST_LOCK_WAITERS  2
+#define TEST_LOCK_ROUNDS   200
+
+// Long enough that only a lost wake reaches it
+#define TEST_TIMEOUT 5000000000ull
+
+static struct Mutex     mutex = MUTEX_INIT;
+static struct Condition round_started = CONDITION_INIT;
+static struct Condition round_seen = CONDITION_INIT;
+
+// Guarded by the mutex
+static unsigned int round_number = 0;
+static unsigned int seen = 0;
+static unsigned int next_waiter = 0;
+static bool         failed = false;
+
+static struct Mutex     locks[TEST_LOCK_WAITERS] = {MUTEX_INIT, MUTEX_INIT};
+static struct Condition lock_round_started = CONDITION_INIT;
+
+// Written with every lock held
+static unsigned int lock_round = 0;
+
+static atomic_32 next_lock_waiter = ATOMIC_INIT(0);
+static atomic_32 lock_seen = ATOMIC_INIT(0);
+static atomic_32 lock_failed = ATOMIC_INIT(0);
+
+static void waiter_saw_round(void) {
+	if (++seen == TEST_WAITERS) condition_signal(&round_seen);
+}
+
+static int waiter(void *argument) {
+	(void) argument;
+
+	mutex_lock(&mutex);
+	bool any = next_waiter++ >= TEST_MUTEX_WAITERS;
+
+	for (unsigned int r = 0; r < TEST_ROUNDS && !failed; r = round_number) {
+		while (round_number == r && !failed) {
+			if (!any) {
+				mutex_wait(&mutex, &round_started);
+				continue;
+			}
+
+			struct WaitObject w;
+			wait_condition(&w, &round_started);
+			mutex_unlock(&mutex);
+
+			rcode result = wait_any_timed(&w, 1, NULL, TEST_TIMEOUT);
+
+			mutex_lock(&mutex);
+			if (result) {
+				printf("wait_any_timed() returned %s (%d) in round %u\n", rcode_string(result), result, r + 1);
+				failed = true;
+			}
+		}
+
+		waiter_saw_round();
+	}
+
+	mutex_unlock(&mutex);
+	return 0;
+}
+
+static int lock_waiter(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next_lock_waiter, 1, ATOMIC_RELAXED);
+	struct Mutex *lock = &locks[index];
+
+	mutex_lock(lock);
+
+	for (unsigned int r = 0; r < TEST_LOCK_ROUNDS && !atomic_load_32(&lock_failed, ATOMIC_RELAXED); r = lock_round) {
+		while (lock_round == r) {
+			if (mutex_timedwait(lock, &lock_round_started, TEST_TIMEOUT) != THREAD_INFO_TIMEOUT) continue;
+
+			printf("A waiter with lock %u was not woken in round %u\n", index, r + 1);
+			atomic_store_32(&lock_failed, 1, ATOMIC_RELAXED);
+			break;
+		}
+
+		atomic_fetch_add_32(&lock_seen, 1, ATOMIC_RELEASE);
+		futex_wake_all(&lock_seen);
+	}
+
+	mutex_unlock(lock);
+	return 0;
+}
+
+static int test_mixed_waits(void) {
+	if (thread_spawn_worker(TEST_WAITERS, waiter, NULL, NULL)) return -1;
+
+	mutex_lock(&mutex);
+
+	for (unsigned int i = 0; i < TEST_ROUNDS && !failed; ++i) {
+		seen = 0;
+		round_number = i + 1;
+		condition_broadcast(&round_started);
+
+		while (seen < TEST_WAITERS && !failed) {
+			if (mutex_timedwait(&mutex, &round_seen, TEST_TIMEOUT) == THREAD_INFO_TIMEOUT) {
+				printf("Round %u was seen by %u of %u waiters\n", i + 1, seen, TEST_WAITERS);
+				failed = true;
+			}
+		}
+	}
+
+	// Release any waiter left behind
+	condition_broadcast(&round_started);
+	mutex_unlock(&mutex);
+
+	if (thread_collect_worker()) return -1;
+
+	return failed ? -1 : 0;
+}
+
+static int test_mixed_locks(void) {
+	if (thread_spawn_worker(TEST_LOCK_WAITERS, lock_waiter, NULL, NULL)) return -1;
+
+	for (unsigned int i = 0; i < TEST_LOCK_ROUNDS && !atomic_load_32(&lock_failed, ATOMIC_RELAXED); ++i) {
+		atomic_store_32(&lock_seen, 0, ATOMIC_RELAXED);
+
+		for (unsigned int l = 0; l < TEST_LOCK_WAITERS; ++l) mutex_lock(&locks[l]);
+		lock_round = i + 1;
+		for (unsigned int l = 0; l < TEST_LOCK_WAITERS; ++l) mutex_unlock(&locks[l]);
+
+		condition_broadcast(&lock_round_started);
+
+		uint32_t seen_now;
+		while ((seen_now = atomic_load_32(&lock_seen, ATOMIC_ACQUIRE)) < TEST_LOCK_WAITERS && !atomic_load_32(&lock_failed, ATOMIC_RELAXED)) {
+			futex_timedwait(&lock_seen, seen_now, TEST_TIMEOUT);
+		}
+	}
+
+	if (thread_collect_worker()) return -1;
+
+	return atomic_load_32(&lock_failed, ATOMIC_RELAXED) ? -1 : 0;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+	if (test_mixed_waits()) return -1;
+	if (test_mixed_locks()) return -1;
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that epoch reclamation never reclaims an object a reader may still
+// hold, and that everything retired is eventually reclaimed exactly once.
+// Threads repeatedly replace a shared object and retire the old one, while
+// others read it within regions.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/epoch.h>
+#include <descent/thread/thread.h>
+
+#define TEST_THREADS    6
+#define TEST_OPERATIONS 20000
+
+// One in every TEST_WRITE_INTERVAL operations replaces the shared object
+#define TEST_WRITE_INTERVAL 4
+#define TEST_NODES (TEST_THREADS * (TEST_OPERATIONS / TEST_WRITE_INTERVAL + 1))
+
+enum {
+	NODE_FREE,
+	NODE_LIVE,
+	NODE_RETIRED,
+	NODE_RECLAIMED,
+};
+
+struct TestNode {
+	struct EpochNode epoch;
+	atomic_32        state;
+};
+
+static struct TestNode nodes[TEST_NODES];
+
+static atomic_ptr current = ATOMIC_INIT(0);
+static atomic_32  next_thread = ATOMIC_INIT(0);
+static atomic_32  failed = ATOMIC_INIT(0);
+static atomic_64  retired = ATOMIC_INIT(0);
+static atomic_64  reclaimed = ATOMIC_INIT(0);
+
+static void fail(const char *what) {
+	printf("%s\n", what);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static void reclaim(struct EpochNode *e) {
+	struct TestNode *n = (struct TestNode *) e;
+
+	if (atomic_exchange_32(&n->state, NODE_RECLAIMED, ATOMIC_RELAXED) != NODE_RETIRED) fail("An object was reclaimed without being retired, or twice");
+	atomic_fetch_add_64(&reclaimed, 1, ATOMIC_RELAXED);
+}
+
+static void read_current(unsigned int spin) {
+	struct TestNode *n = (struct TestNode *) atomic_load_ptr(&current, ATOMIC_ACQUIRE);
+	if (!n) return;
+
+	if (atomic_load_32(&n->state, ATOMIC_RELAXED) == NODE_RECLAIMED) fail("A reader found a reclaimed object");
+	for (volatile unsigned int i = 0; i < spin; ++i);
+	if (atomic_load_32(&n->state, ATOMIC_RELAXED) == NODE_RECLAIMED) fail("An object was reclaimed while a reader held it");
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next_thread, 1, ATOMIC_RELAXED);
+	struct TestNode *pool = &nodes[index * (TEST_OPERATIONS / TEST_WRITE_INTERVAL + 1)];
+	unsigned int used = 0;
+
+	for (unsigned int i = 0; i < TEST_OPERATIONS && !atomic_load_32(&failed, ATOMIC_RELAXED); ++i) {
+		if ((i + index) % TEST_WRITE_INTERVAL) {
+			if (epoch_enter()) return 1;
+
+			// Nested regions end with the outermost exit
+			if (i % 16 == 0) {
+				if (epoch_enter()) return 1;
+				read_current(16);
+				if (epoch_exit()) return 1;
+			}
+
+			read_current(i % 64 ? 16 : 4096);
+			if (epoch_exit()) return 1;
+			continue;
+		}
+
+		struct TestNode *n = &pool[used++];
+		n->epoch = (struct EpochNode) EPOCH_NODE_INIT;
+		atomic_store_32(&n->state, NODE_LIVE, ATOMIC_RELAXED);
+
+		struct TestNode *old = (struct TestNode *) atomic_exchange_ptr(&current, (uintptr_t) n, ATOMIC_ACQ_REL);
+		if (!old) continue;
+
+		atomic_store_32(&old->state, NODE_RETIRED, ATOMIC_RELAXED);
+		if (epoch_retire(&old->epoch, reclaim)) return 1;
+		atomic_fetch_add_64(&retired, 1, ATOMIC_RELAXED);
+	}
+
+	if (epoch_exit() != DESCENT_ERROR_STATE) fail("A region was exited without being entered");
+
+	// Objects are reclaimed by the thread which retired them
+	if (epoch_synchronize()) return 1;
+	return 0;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+	if (thread_spawn_worker(TEST_THREADS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	for (unsigned int i = 0; i < TEST_THREADS; ++i) {
+		if (thread_code_worker(i)) {
+			printf("Worker %u got an error from the epoch functions\n", i);
+			return -1;
+		}
+	}
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	uint64_t r = atomic_load_64(&retired, ATOMIC_RELAXED);
+	uint64_t c = atomic_load_64(&reclaimed, ATOMIC_RELAXED);
+	if (r != c) {
+		printf("Retired %llu objects, but reclaimed %llu\n", (unsigned long long) r, (unsigned long long) c);
+		return -1;
+	}
+
+	printf("%llu objects retired and reclaimed\n", (unsigned long long) r);
+	return 0;
+}
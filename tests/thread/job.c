@@ -0,0 +1,359 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Exercises the job system end to end. Checks that every submitted job runs
+// once, that jobs submitted with job_submit_after() wait for the stage before
+// them, that a job suspended in job_wait() resumes intact on another worker,
+// that the pool can shrink and grow while work is queued, and that stopping
+// with parked workers still runs everything queued.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <descent/alloc/stackalloc.h>
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/futex.h>
+#include <descent/thread/job.h>
+#include <descent/time.h>
+#include <intern/thread/tid.h>
+
+#define TEST_WORKERS 4
+#define TEST_JOBS    4096
+
+#define TEST_STAGES         8
+#define TEST_JOBS_PER_STAGE 64
+
+// Jobs which spawn children and wait on them, out of every TEST_NESTED_INTERVAL
+#define TEST_NESTED_INTERVAL 16
+#define TEST_NESTED_CHILDREN 8
+
+#define TEST_SCRATCH_SIZE 256
+
+static const unsigned int test_worker_counts[] = {1, TEST_WORKERS, 2, 1, 3, TEST_WORKERS};
+
+static atomic_32 failed = ATOMIC_INIT(0);
+static atomic_64 ran = ATOMIC_INIT(0);
+
+static struct Job jobs[TEST_JOBS];
+
+static struct Job        stage_jobs[TEST_STAGES][TEST_JOBS_PER_STAGE];
+static struct JobCounter stage_counters[TEST_STAGES];
+static atomic_32         stage_done[TEST_STAGES];
+static atomic_32         stage_release = ATOMIC_INIT(0);
+
+static atomic_32         migrate_started = ATOMIC_INIT(0);
+static atomic_32         migrate_waiting = ATOMIC_INIT(0);
+static atomic_32         migrate_release = ATOMIC_INIT(0);
+static atomic_32         migrate_moved = ATOMIC_INIT(0);
+static struct JobCounter migrate_gate = JOB_COUNTER_INIT;
+
+static void fail(const char *what) {
+	printf("%s\n", what);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static void count(void *argument) {
+	(void) argument;
+	atomic_fetch_add_64(&ran, 1, ATOMIC_RELAXED);
+}
+
+static void child(void *argument) {
+	atomic_fetch_add_32(argument, 1, ATOMIC_RELEASE);
+	atomic_fetch_add_64(&ran, 1, ATOMIC_RELAXED);
+}
+
+static void nested(void *argument) {
+	(void) argument;
+
+	struct Job children[TEST_NESTED_CHILDREN];
+	struct JobCounter counter = JOB_COUNTER_INIT;
+	atomic_32 finished = ATOMIC_INIT(0);
+	for (unsigned int i = 0; i < TEST_NESTED_CHILDREN; ++i) children[i] = (struct Job) JOB_INIT(child, &finished);
+
+	if (job_submit(children, TEST_NESTED_CHILDREN, &counter)) fail("A job could not submit its children");
+	else if (job_wait(&counter)) fail("A job could not wait on its children");
+	else if (atomic_load_32(&finished, ATOMIC_ACQUIRE) != TEST_NESTED_CHILDREN) fail("job_wait() returned before the children finished");
+
+	atomic_fetch_add_64(&ran, 1, ATOMIC_RELAXED);
+}
+
+// Submits a batch of jobs, optionally mixing in jobs which wait on children,
+// and returns the number of jobs it will run
+static uint64_t submit_batch(struct JobCounter *counter, bool parents) {
+	uint64_t expected = 0;
+
+	for (unsigned int i = 0; i < TEST_JOBS; ++i) {
+		bool parent = parents && i % TEST_NESTED_INTERVAL == 0;
+		jobs[i] = (struct Job) JOB_INIT(parent ? nested : count, NULL);
+		expected += parent ? TEST_NESTED_CHILDREN + 1 : 1;
+	}
+
+	if (job_submit(jobs, TEST_JOBS, counter)) {
+		fail("job_submit() failed");
+		return 0;
+	}
+
+	return expected;
+}
+
+static bool check_ran(uint64_t expected) {
+	uint64_t total = atomic_exchange_64(&ran, 0, ATOMIC_RELAXED);
+	if (total == expected) return true;
+
+	printf("Ran %llu jobs, but %llu were submitted\n", (unsigned long long) total, (unsigned long long) expected);
+	return false;
+}
+
+static bool test_submit(void) {
+	struct JobCounter counter = JOB_COUNTER_INIT;
+	uint64_t expected = submit_batch(&counter, true);
+
+	rcode result = job_wait(&counter);
+	if (result) {
+		printf("job_wait() returned %s (%d)\n", rcode_string(result), result);
+		return false;
+	}
+
+	return check_ran(expected);
+}
+
+// Blocks its worker until a flag is set
+static void hold(void *argument) {
+	atomic_32 *release = argument;
+	while (!atomic_load_32(release, ATOMIC_ACQUIRE)) futex_wait(release, 0);
+}
+
+static void stage(void *argument) {
+	unsigned int index = (unsigned int) (uintptr_t) argument;
+
+	if (index && atomic_load_32(&stage_done[index - 1], ATOMIC_ACQUIRE) != TEST_JOBS_PER_STAGE) fail("A stage started before the one it was submitted after finished");
+
+	atomic_fetch_add_32(&stage_done[index], 1, ATOMIC_RELEASE);
+}
+
+static bool test_chain(void) {
+	struct Job gate = JOB_INIT(hold, &stage_release);
+	struct JobCounter gate_counter = JOB_COUNTER_INIT;
+
+	for (unsigned int s = 0; s < TEST_STAGES; ++s) {
+		stage_counters[s] = (struct JobCounter) JOB_COUNTER_INIT;
+		atomic_store_32(&stage_done[s], 0, ATOMIC_RELAXED);
+		for (unsigned int i = 0; i < TEST_JOBS_PER_STAGE; ++i) stage_jobs[s][i] = (struct Job) JOB_INIT(stage, (void *) (uintptr_t) s);
+	}
+
+	// The whole chain is held behind the gate, so that only the dependencies
+	// order the stages
+	if (job_submit(&gate, 1, &gate_counter)) return false;
+
+	for (unsigned int s = 0; s < TEST_STAGES; ++s) {
+		struct JobCounter *dependency = s ? &stage_counters[s - 1] : &gate_counter;
+
+		rcode result = job_submit_after(dependency, stage_jobs[s], TEST_JOBS_PER_STAGE, &stage_counters[s]);
+		if (result) {
+			printf("job_submit_after() returned %s (%d)\n", rcode_string(result), result);
+			return false;
+		}
+	}
+
+	atomic_store_32(&stage_release, 1, ATOMIC_RELEASE);
+	futex_wake_all(&stage_release);
+
+	if (job_wait(&stage_counters[TEST_STAGES - 1])) return false;
+
+	for (unsigned int s = 0; s < TEST_STAGES; ++s) {
+		if (atomic_load_32(&stage_done[s], ATOMIC_ACQUIRE) != TEST_JOBS_PER_STAGE) {
+			printf("Stage %u ran %u of its jobs\n", s, atomic_load_32(&stage_done[s], ATOMIC_RELAXED));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Waits until every migration job has started, so that each holds a worker
+static void migrate_gather(void) {
+	uint32_t started = atomic_add_fetch_32(&migrate_started, 1, ATOMIC_ACQ_REL);
+	if (started == TEST_WORKERS) futex_wake_all(&migrate_started);
+
+	while (started < TEST_WORKERS) {
+		futex_wait(&migrate_started, started);
+		started = atomic_load_32(&migrate_started, ATOMIC_ACQUIRE);
+	}
+}
+
+static void migrate_hold(void *argument) {
+	migrate_gather();
+	hold(argument);
+}
+
+static void migrate(void *argument) {
+	unsigned char tag = (unsigned char) (uintptr_t) argument;
+
+	Stackalloc *stack;
+	if (stackalloc_self(&stack)) {
+		fail("stackalloc_self() failed");
+		return;
+	}
+
+	StackallocMarker marker = stackalloc_push(stack);
+	unsigned char *scratch;
+	if (stackalloc(stack, TEST_SCRATCH_SIZE, 1, (void **) &scratch)) {
+		fail("stackalloc() failed");
+		return;
+	}
+	memset(scratch, tag, TEST_SCRATCH_SIZE);
+
+	migrate_gather();
+
+	thread_id before = tid_self();
+	atomic_fetch_add_32(&migrate_waiting, 1, ATOMIC_RELEASE);
+	futex_wake_all(&migrate_waiting);
+	if (job_wait(&migrate_gate)) fail("job_wait() failed in a suspended job");
+	if (!tid_is_self(before)) atomic_fetch_add_32(&migrate_moved, 1, ATOMIC_RELAXED);
+
+	// Another job allocating while this one was suspended must not have
+	// touched its scratch memory
+	struct JobCounter counter = JOB_COUNTER_INIT;
+	struct Job child = JOB_INIT(nested, NULL);
+	if (job_submit(&child, 1, &counter) || job_wait(&counter)) fail("A resumed job could not run a child");
+
+	Stackalloc *after;
+	if (stackalloc_self(&after) || after != stack) fail("A job's stack allocator changed across job_wait()");
+
+	for (unsigned int i = 0; i < TEST_SCRATCH_SIZE; ++i) {
+		if (scratch[i] != tag) {
+			fail("A job's scratch memory was overwritten while it was suspended");
+			break;
+		}
+	}
+
+	stackalloc_pop(stack, marker);
+}
+
+static bool test_migration(void) {
+	struct Job gate = JOB_INIT(migrate_hold, &migrate_release);
+	struct Job waiters[TEST_WORKERS - 1];
+	struct JobCounter counter = JOB_COUNTER_INIT;
+
+	for (unsigned int i = 0; i < TEST_WORKERS - 1; ++i) waiters[i] = (struct Job) JOB_INIT(migrate, (void *) (uintptr_t) (i + 1));
+
+	if (job_submit(&gate, 1, &migrate_gate)) return false;
+	if (job_submit(waiters, TEST_WORKERS - 1, &counter)) return false;
+
+	// Every job holds its own worker, and the waiters suspend on the gate.
+	// Shrinking the pool to one worker parks the rest, so waiters which
+	// started on them must resume on the remaining one.
+	uint32_t waiting;
+	while ((waiting = atomic_load_32(&migrate_waiting, ATOMIC_ACQUIRE)) < TEST_WORKERS - 1) futex_wait(&migrate_waiting, waiting);
+	if (job_set_worker_count(1)) return false;
+
+	uint64_t start = time_nanoseconds();
+	while (time_nanoseconds() - start < 10000000);
+
+	atomic_store_32(&migrate_release, 1, ATOMIC_RELEASE);
+	futex_wake_all(&migrate_release);
+
+	if (job_wait(&counter)) return false;
+	if (job_set_worker_count(TEST_WORKERS)) return false;
+
+	atomic_store_64(&ran, 0, ATOMIC_RELAXED);
+
+#if DESCENT_JOB_FIBERS
+	if (!atomic_load_32(&migrate_moved, ATOMIC_RELAXED)) {
+		printf("No suspended job resumed on another worker\n");
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+static bool test_resize(void) {
+	unsigned int rounds = sizeof(test_worker_counts) / sizeof(test_worker_counts[0]);
+
+	for (unsigned int r = 0; r < rounds; ++r) {
+		struct JobCounter counter = JOB_COUNTER_INIT;
+		uint64_t expected = submit_batch(&counter, true);
+
+		rcode result = job_set_worker_count(test_worker_counts[r]);
+		if (result) {
+			printf("job_set_worker_count(%u) returned %s (%d)\n", test_worker_counts[r], rcode_string(result), result);
+			return false;
+		}
+
+		if (job_wait(&counter)) return false;
+		if (!check_ran(expected)) return false;
+
+		if (job_worker_count() != test_worker_counts[r]) {
+			printf("job_worker_count() returned %u after setting %u\n", job_worker_count(), test_worker_counts[r]);
+			return false;
+		}
+	}
+
+	if (job_set_worker_count(0) != DESCENT_ERROR_INVALID) {
+		printf("job_set_worker_count(0) was accepted\n");
+		return false;
+	}
+
+	return true;
+}
+
+static bool test_stop_parked(void) {
+	if (job_set_worker_count(1)) return false;
+
+	// Nothing waits on the batch, so stopping must run it. Jobs cannot be
+	// submitted once stopping has begun, so none of them have children.
+	uint64_t expected = submit_batch(NULL, false);
+
+	rcode result = job_stop();
+	if (result) {
+		printf("job_stop() with parked workers returned %s (%d)\n", rcode_string(result), result);
+		return false;
+	}
+
+	if (!check_ran(expected)) return false;
+
+	if (job_stop() != DESCENT_ERROR_STATE) {
+		printf("job_stop() on a stopped job system did not fail\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+
+	rcode result = job_start(TEST_WORKERS);
+	if (result) {
+		printf("job_start() returned %s (%d)\n", rcode_string(result), result);
+		return -1;
+	}
+
+	if (!test_submit()) return -1;
+	if (!test_chain()) return -1;
+	if (!test_migration()) return -1;
+	if (!test_resize()) return -1;
+	if (!test_stop_parked()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	printf("%u of %u suspended jobs resumed on another worker\n", atomic_load_32(&migrate_moved, ATOMIC_RELAXED), TEST_WORKERS - 1);
+	return 0;
+}
@@ -0,0 +1,140 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Stresses the mutex handoff. One thread holds the lock past the fairness
+// interval, so unlocks hand it to waiters, while the others mix mutex_lock()
+// and mutex_timedlock() with timeouts close to the interval, so that timeouts
+// race handoffs. Checks mutual exclusion, that every acquisition is counted,
+// and that the mutex is left free.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/mutex.h>
+#include <descent/thread/thread.h>
+#include <descent/time.h>
+
+#define TEST_THREADS   6
+#define TEST_HOT_LOCKS 100
+
+// Longer than the fairness interval, so that waiters get the lock handed over
+#define TEST_HOT_HOLD (DESCENT_MUTEX_FAIR_INTERVAL + DESCENT_MUTEX_FAIR_INTERVAL / 2)
+
+static const uint64_t test_timeouts[] = {
+	DESCENT_MUTEX_FAIR_INTERVAL / 10,
+	DESCENT_MUTEX_FAIR_INTERVAL,
+	DESCENT_MUTEX_FAIR_INTERVAL + DESCENT_MUTEX_FAIR_INTERVAL / 5,
+	DESCENT_MUTEX_FAIR_INTERVAL * 3,
+};
+
+static struct Mutex mutex = MUTEX_INIT;
+static atomic_32    inside = ATOMIC_INIT(0);
+static atomic_32    next = ATOMIC_INIT(0);
+static atomic_32    stop = ATOMIC_INIT(0);
+static atomic_32    failed = ATOMIC_INIT(0);
+static atomic_64    acquired = ATOMIC_INIT(0);
+static atomic_64    timeouts = ATOMIC_INIT(0);
+
+// Guarded by the mutex
+static uint64_t counter = 0;
+
+static void fail(const char *what, rcode result) {
+	printf("%s returned %s (%d)\n", what, rcode_string(result), result);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static void hold(uint64_t nanoseconds) {
+	if (atomic_exchange_32(&inside, 1, ATOMIC_ACQUIRE)) {
+		printf("Two threads held the mutex at once\n");
+		atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+	}
+
+	++counter;
+
+	uint64_t start = time_nanoseconds();
+	while (time_nanoseconds() - start < nanoseconds);
+
+	atomic_store_32(&inside, 0, ATOMIC_RELEASE);
+	atomic_fetch_add_64(&acquired, 1, ATOMIC_RELAXED);
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next, 1, ATOMIC_RELAXED);
+	rcode result;
+
+	if (!index) {
+		for (unsigned int i = 0; i < TEST_HOT_LOCKS && !atomic_load_32(&failed, ATOMIC_RELAXED); ++i) {
+			if ((result = mutex_lock(&mutex))) fail("mutex_lock()", result);
+			hold(TEST_HOT_HOLD);
+			if ((result = mutex_unlock(&mutex))) fail("mutex_unlock()", result);
+		}
+
+		atomic_store_32(&stop, 1, ATOMIC_RELAXED);
+		return 0;
+	}
+
+	for (unsigned int i = index; !atomic_load_32(&stop, ATOMIC_RELAXED) && !atomic_load_32(&failed, ATOMIC_RELAXED); ++i) {
+		unsigned int choice = i % (1 + sizeof(test_timeouts) / sizeof(test_timeouts[0]));
+
+		if (!choice) result = mutex_lock(&mutex);
+		else result = mutex_timedlock(&mutex, test_timeouts[choice - 1]);
+
+		if (result == THREAD_INFO_TIMEOUT) {
+			atomic_fetch_add_64(&timeouts, 1, ATOMIC_RELAXED);
+			continue;
+		}
+		if (result) {
+			fail(choice ? "mutex_timedlock()" : "mutex_lock()", result);
+			break;
+		}
+
+		hold(i % 8 ? 1000 : 100000);
+		if ((result = mutex_unlock(&mutex))) fail("mutex_unlock()", result);
+	}
+
+	return 0;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+	if (thread_spawn_worker(TEST_THREADS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	uint64_t total = atomic_load_64(&acquired, ATOMIC_RELAXED);
+	if (counter != total) {
+		printf("Counted %llu acquisitions, but %llu were made\n", (unsigned long long) counter, (unsigned long long) total);
+		return -1;
+	}
+
+	// A handoff left reserved for a thread which timed out would keep the
+	// mutex locked
+	rcode result = mutex_trylock(&mutex);
+	if (result) {
+		printf("mutex_trylock() on the idle mutex returned %s (%d)\n", rcode_string(result), result);
+		return -1;
+	}
+	if (mutex_unlock(&mutex)) return -1;
+
+	printf("%llu acquisitions, %llu timeouts\n", (unsigned long long) total, (unsigned long long) atomic_load_64(&timeouts, ATOMIC_RELAXED));
+	return 0;
+}
@@ -0,0 +1,153 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Stresses the blocking queue operations. Producers and consumers outnumber
+// the cells of a small queue, so that pushes park while it is full and pops
+// park while it is empty, mixed with non-blocking attempts. Checks that every
+// value is popped exactly once, and that each consumer sees the values of each
+// producer in the order they were pushed.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/queue.h>
+#include <descent/thread/thread.h>
+
+#define TEST_PRODUCERS 3
+#define TEST_CONSUMERS 3
+#define TEST_VALUES    50000
+#define TEST_CELLS     4
+
+static struct QueueCell cells[TEST_CELLS];
+static struct Queue     queue;
+
+static atomic_32 next_thread = ATOMIC_INIT(0);
+static atomic_32 producers_done = ATOMIC_INIT(0);
+static atomic_32 failed = ATOMIC_INIT(0);
+static atomic_32 seen[TEST_PRODUCERS * TEST_VALUES];
+
+static void fail(const char *what, rcode result) {
+	printf("%s returned %s (%d)\n", what, rcode_string(result), result);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static int producer(unsigned int index) {
+	rcode result;
+
+	for (unsigned int k = 0; k < TEST_VALUES; ++k) {
+		// Zero is left for the sentinel which stops consumers
+		void *value = (void *) (uintptr_t) (index * TEST_VALUES + k + 1);
+
+		// Half the values are first offered without blocking
+		result = k % 2 ? queue_trypush(&queue, value) : THREAD_INFO_BUSY;
+		if (result == THREAD_INFO_BUSY) result = queue_push(&queue, value);
+
+		if (result) {
+			fail("queue_push()", result);
+			return 1;
+		}
+	}
+
+	// The last producer to finish stops every consumer
+	if (atomic_add_fetch_32(&producers_done, 1, ATOMIC_ACQ_REL) == TEST_PRODUCERS) {
+		for (unsigned int i = 0; i < TEST_CONSUMERS; ++i) {
+			if ((result = queue_push(&queue, NULL))) {
+				fail("queue_push()", result);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int consumer(unsigned int index) {
+	unsigned int last[TEST_PRODUCERS] = {0};
+	rcode result;
+
+	for (unsigned int i = 0;; ++i) {
+		void *value;
+
+		result = i % 2 ? queue_trypop(&queue, &value) : THREAD_INFO_BUSY;
+		if (result == THREAD_INFO_BUSY) result = queue_pop(&queue, &value);
+
+		if (result) {
+			fail("queue_pop()", result);
+			return 1;
+		}
+
+		uintptr_t v = (uintptr_t) value;
+		if (!v) return 0;
+
+		unsigned int position = (unsigned int) (v - 1);
+		unsigned int from = position / TEST_VALUES;
+		unsigned int k = position % TEST_VALUES + 1;
+
+		if (from >= TEST_PRODUCERS) {
+			printf("Consumer %u popped a value which was never pushed\n", index);
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+			return 1;
+		}
+
+		if (atomic_exchange_32(&seen[position], 1, ATOMIC_RELAXED)) {
+			printf("A value was popped twice\n");
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+		}
+
+		if (k <= last[from]) {
+			printf("Consumer %u saw values from producer %u out of order\n", index, from);
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+		}
+		last[from] = k;
+	}
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next_thread, 1, ATOMIC_RELAXED);
+	if (index < TEST_PRODUCERS) return producer(index);
+	return consumer(index - TEST_PRODUCERS);
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+	if (queue_init(&queue, cells, TEST_CELLS)) return -1;
+
+	if (thread_spawn_worker(TEST_PRODUCERS + TEST_CONSUMERS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	for (unsigned int i = 0; i < TEST_PRODUCERS * TEST_VALUES; ++i) {
+		if (!atomic_load_32(&seen[i], ATOMIC_RELAXED)) {
+			printf("Value %u was pushed but never popped\n", i + 1);
+			return -1;
+		}
+	}
+
+	void *value;
+	if (queue_count(&queue) || queue_trypop(&queue, &value) != THREAD_INFO_BUSY) {
+		printf("The queue was not left empty\n");
+		return -1;
+	}
+
+	printf("%u values passed through %u cells\n", TEST_PRODUCERS * TEST_VALUES, TEST_CELLS);
+	return 0;
+}
@@ -0,0 +1,180 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks reader/writer exclusion and downgrades, for both the plain and the
+// sharded reader set. Threads mix reads, writes, write trylocks and
+// downgrades, and track who is inside so that any overlap is caught.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/rwlock.h>
+#include <descent/thread/thread.h>
+
+#define TEST_THREADS    6
+#define TEST_OPERATIONS 50000
+#define TEST_SHARDS     8
+
+static RWLock             lock;
+static struct RWLockShard shards[TEST_SHARDS];
+
+static atomic_32 readers = ATOMIC_INIT(0);
+static atomic_32 writers = ATOMIC_INIT(0);
+static atomic_32 next = ATOMIC_INIT(0);
+static atomic_32 failed = ATOMIC_INIT(0);
+
+// Written only under the write lock
+static volatile uint64_t value = 0;
+static volatile uint64_t copy = 0;
+static uint64_t          writes = 0;
+
+static void fail(const char *what) {
+	printf("%s\n", what);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static void enter_read(void) {
+	atomic_fetch_add_32(&readers, 1, ATOMIC_SEQ_CST);
+	if (atomic_load_32(&writers, ATOMIC_SEQ_CST)) fail("A reader entered while a writer held the lock");
+}
+
+static void exit_read(void) {
+	if (value != copy) fail("A reader saw a partial write");
+	atomic_fetch_sub_32(&readers, 1, ATOMIC_SEQ_CST);
+}
+
+static void enter_write(void) {
+	if (atomic_fetch_add_32(&writers, 1, ATOMIC_SEQ_CST)) fail("Two writers held the lock at once");
+	if (atomic_load_32(&readers, ATOMIC_SEQ_CST)) fail("A writer entered while a reader held the lock");
+}
+
+static void write_value(uint64_t token) {
+	value = token;
+	for (volatile unsigned int spin = 0; spin < 64; ++spin);
+	copy = token;
+	++writes;
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	uint64_t index = atomic_fetch_add_32(&next, 1, ATOMIC_RELAXED);
+
+	for (uint64_t i = 0; i < TEST_OPERATIONS && !atomic_load_32(&failed, ATOMIC_RELAXED); ++i) {
+		uint64_t token = (index << 32) | (i + 1);
+
+		switch (i % 10) {
+			case 0:
+				if (rwlock_write_lock(&lock)) return 1;
+				enter_write();
+				write_value(token);
+				atomic_fetch_sub_32(&writers, 1, ATOMIC_SEQ_CST);
+				if (rwlock_write_unlock(&lock)) return 1;
+				break;
+
+			// A downgrade keeps out other writers, so the value written just
+			// before it is still there once the lock is shared
+			case 1:
+				if (rwlock_write_lock(&lock)) return 1;
+				enter_write();
+				write_value(token);
+				atomic_fetch_add_32(&readers, 1, ATOMIC_SEQ_CST);
+				atomic_fetch_sub_32(&writers, 1, ATOMIC_SEQ_CST);
+				if (rwlock_downlock(&lock)) return 1;
+
+				if (rwlock_read_lock(&lock) != THREAD_ERROR_DEADLOCK) fail("A downgraded lock was locked for reading again");
+				for (volatile unsigned int spin = 0; spin < 256; ++spin);
+				if (value != token) fail("A writer got in during a downgrade");
+
+				exit_read();
+				if (rwlock_read_unlock(&lock)) return 1;
+				break;
+
+			case 2:
+				if (rwlock_write_trylock(&lock)) break;
+				enter_write();
+				write_value(token);
+				atomic_fetch_sub_32(&writers, 1, ATOMIC_SEQ_CST);
+				if (rwlock_write_unlock(&lock)) return 1;
+				break;
+
+			case 3:
+				if (rwlock_read_trylock(&lock)) break;
+				enter_read();
+				exit_read();
+				if (rwlock_read_unlock(&lock)) return 1;
+				break;
+
+			default:
+				if (rwlock_read_lock(&lock)) return 1;
+				enter_read();
+				for (volatile unsigned int spin = 0; spin < 64; ++spin);
+				exit_read();
+				if (rwlock_read_unlock(&lock)) return 1;
+				break;
+		}
+	}
+
+	// Releasing a lock which is not held is refused
+	if (rwlock_read_unlock(&lock) != DESCENT_ERROR_FORBIDDEN) fail("An unheld read lock was released");
+	if (rwlock_write_unlock(&lock) != DESCENT_ERROR_FORBIDDEN) fail("An unheld write lock was released");
+
+	return 0;
+}
+
+static int run(const char *name) {
+	atomic_store_32(&next, 0, ATOMIC_RELAXED);
+	writes = 0;
+
+	if (thread_spawn_worker(TEST_THREADS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	for (unsigned int i = 0; i < TEST_THREADS; ++i) {
+		if (thread_code_worker(i)) {
+			printf("%s: worker %u failed to lock or unlock\n", name, i);
+			return -1;
+		}
+	}
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) {
+		printf("%s: failed\n", name);
+		return -1;
+	}
+
+	// Every write has been released, so the lock is free for writing
+	if (rwlock_write_trylock(&lock) || rwlock_write_unlock(&lock)) {
+		printf("%s: the lock was left held\n", name);
+		return -1;
+	}
+
+	printf("%s: %llu writes\n", name, (unsigned long long) writes);
+	return 0;
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+
+	lock = (RWLock) RWLOCK_INIT;
+	if (run("plain")) return -1;
+
+	if (rwlock_init_sharded(&lock, shards, TEST_SHARDS)) return -1;
+	if (run("sharded")) return -1;
+
+	return 0;
+}
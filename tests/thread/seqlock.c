@@ -0,0 +1,205 @@
+/* Copyright 2025 XavierHarkonnen9 and Enlarium
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that readers of a sequence lock never act on a torn copy. Every word
+// of the shared data holds the same generation, so a read which overlapped a
+// write would see words from different generations. One set of data is
+// replaced with seqlock_write() and read with seqlock_read(), and another is
+// updated word by word between seqlock_write_begin() and seqlock_write_end(),
+// and read with seqlock_read_begin() and seqlock_read_retry(). Two writers
+// increment the second set, which also checks that writers are serialized.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <descent/core.h>
+#include <descent/rcode.h>
+#include <descent/thread/atomic.h>
+#include <descent/thread/seqlock.h>
+#include <descent/thread/thread.h>
+
+#define TEST_WRITERS 2
+#define TEST_READERS 4
+#define TEST_READS   100000
+#define TEST_WORDS   8
+
+// Iterations spun between the words of an update or a read, to widen the
+// window in which they overlap
+#define TEST_SPIN 64
+
+struct TestCopy {
+	uint64_t words[TEST_WORDS];
+};
+
+struct TestWords {
+	atomic_64 words[TEST_WORDS];
+};
+
+static struct SeqLock   lock = SEQLOCK_INIT;
+static struct TestCopy  copied;
+static struct TestWords updated;
+
+static atomic_32 next_thread = ATOMIC_INIT(0);
+static atomic_32 readers_done = ATOMIC_INIT(0);
+static atomic_64 writes = ATOMIC_INIT(0);
+static atomic_32 failed = ATOMIC_INIT(0);
+static atomic_64 retries = ATOMIC_INIT(0);
+
+static void fail(const char *what, rcode result) {
+	printf("%s returned %s (%d)\n", what, rcode_string(result), result);
+	atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+}
+
+static bool torn(const uint64_t *words) {
+	for (unsigned int i = 1; i < TEST_WORDS; ++i) {
+		if (words[i] != words[0]) return true;
+	}
+	return false;
+}
+
+static int writer(unsigned int index) {
+	rcode result;
+
+	// Writers keep going until every reader is done, so that they overlap
+	// however the threads are scheduled
+	for (uint64_t w = 1; atomic_load_32(&readers_done, ATOMIC_ACQUIRE) < TEST_READERS && !atomic_load_32(&failed, ATOMIC_RELAXED); ++w) {
+		// Only the first writer replaces the copied set, so its generations
+		// only grow
+		if (!index) {
+			struct TestCopy data;
+			for (unsigned int i = 0; i < TEST_WORDS; ++i) data.words[i] = w;
+
+			if ((result = seqlock_write(&lock, &copied, &data, sizeof(data)))) {
+				fail("seqlock_write()", result);
+				return 1;
+			}
+		}
+
+		if ((result = seqlock_write_begin(&lock))) {
+			fail("seqlock_write_begin()", result);
+			return 1;
+		}
+
+		// Writers are serialized, so the increment cannot be lost
+		uint64_t generation = atomic_load_64(&updated.words[0], ATOMIC_RELAXED) + 1;
+		for (unsigned int i = 0; i < TEST_WORDS; ++i) {
+			atomic_store_64(&updated.words[i], generation, ATOMIC_RELAXED);
+			for (volatile unsigned int spin = 0; spin < TEST_SPIN; ++spin);
+		}
+
+		if ((result = seqlock_write_end(&lock))) {
+			fail("seqlock_write_end()", result);
+			return 1;
+		}
+
+		atomic_fetch_add_64(&writes, 1, ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+static int reader(unsigned int index) {
+	uint64_t last_copied = 0;
+	uint64_t last_updated = 0;
+	rcode result;
+
+	for (unsigned int r = 0; r < TEST_READS; ++r) {
+		uint64_t words[TEST_WORDS];
+
+		if (r % 2) {
+			struct TestCopy data;
+			if ((result = seqlock_read(&lock, &data, &copied, sizeof(data)))) {
+				fail("seqlock_read()", result);
+				return 1;
+			}
+
+			if (torn(data.words)) {
+				printf("Reader %u got a torn copy from seqlock_read()\n", index);
+				atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+				return 1;
+			}
+
+			if (data.words[0] < last_copied) {
+				printf("Reader %u saw the copied data go back in time\n", index);
+				atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+				return 1;
+			}
+			last_copied = data.words[0];
+			continue;
+		}
+
+		uint32_t sequence;
+		do {
+			if ((result = seqlock_read_begin(&lock, &sequence))) {
+				fail("seqlock_read_begin()", result);
+				return 1;
+			}
+
+			for (unsigned int i = 0; i < TEST_WORDS; ++i) {
+				words[i] = atomic_load_64(&updated.words[i], ATOMIC_RELAXED);
+				for (volatile unsigned int spin = 0; spin < TEST_SPIN; ++spin);
+			}
+		} while (seqlock_read_retry(&lock, sequence) && (atomic_fetch_add_64(&retries, 1, ATOMIC_RELAXED), true));
+
+		if (torn(words)) {
+			printf("Reader %u acted on a torn read which seqlock_read_retry() accepted\n", index);
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+			return 1;
+		}
+
+		if (words[0] < last_updated) {
+			printf("Reader %u saw the updated data go back in time\n", index);
+			atomic_store_32(&failed, 1, ATOMIC_RELAXED);
+			return 1;
+		}
+		last_updated = words[0];
+	}
+
+	atomic_fetch_add_32(&readers_done, 1, ATOMIC_RELEASE);
+	return 0;
+}
+
+static int worker(void *argument) {
+	(void) argument;
+
+	unsigned int index = atomic_fetch_add_32(&next_thread, 1, ATOMIC_RELAXED);
+	if (index < TEST_WRITERS) return writer(index);
+	return reader(index - TEST_WRITERS);
+}
+
+int main(void) {
+	if (descent_init()) return -1;
+
+	if (seqlock_write_end(&lock) != DESCENT_ERROR_STATE) {
+		printf("seqlock_write_end() without a write did not fail\n");
+		return -1;
+	}
+
+	if (thread_spawn_worker(TEST_WRITERS + TEST_READERS, worker, NULL, NULL)) return -1;
+	if (thread_collect_worker()) return -1;
+
+	if (atomic_load_32(&failed, ATOMIC_RELAXED)) return -1;
+
+	uint64_t total = atomic_load_64(&writes, ATOMIC_RELAXED);
+	uint64_t generation = atomic_load_64(&updated.words[0], ATOMIC_RELAXED);
+	if (generation != total) {
+		printf("Made %llu writes, but the data counted %llu\n", (unsigned long long) total, (unsigned long long) generation);
+		return -1;
+	}
+
+	printf("%llu writes, %llu reads retried\n", (unsigned long long) total, (unsigned long long) atomic_load_64(&retries, ATOMIC_RELAXED));
+	return 0;
+}